@@ -7,6 +7,7 @@
 #include <QVBoxLayout>
 
 #include "../mat_to_qimage.h"
+#include "../trace.h"
 
 ImwriteLessonWidget::ImwriteLessonWidget(QWidget *parent)
     : QWidget(parent)
@@ -63,7 +64,12 @@ void ImwriteLessonWidget::generateAndShowImage()
     const cv::Mat image = generateImage();
     const std::string outputPath = "generated_from_imwrite.png";
 
-    if (!cv::imwrite(outputPath, image))
+    bool saved = false;
+    {
+        TRACE_SCOPE("imwrite");
+        saved = cv::imwrite(outputPath, image);
+    }
+    if (!saved)
     {
         statusLabel->setText(QStringLiteral("保存失败：%1").arg(QString::fromStdString(outputPath)));
     }
@@ -72,7 +78,7 @@ void ImwriteLessonWidget::generateAndShowImage()
         statusLabel->setText(QStringLiteral("已保存到项目根目录：%1").arg(QString::fromStdString(outputPath)));
     }
 
-    const QImage qimage = matToQImage(image);
+    const QImage qimage = matToQImage(image, MatToQImageMode::Share);
     if (qimage.isNull())
     {
         QMessageBox::critical(this,
@@ -81,5 +87,6 @@ void ImwriteLessonWidget::generateAndShowImage()
         return;
     }
 
+    TRACE_SCOPE("QPixmap::fromImage");
     imageLabel->setPixmap(QPixmap::fromImage(qimage));
 }
@@ -14,7 +14,9 @@
 
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
 #include "../mat_to_qimage.h"
+#include "../trace.h"
 
 ImreadLessonWidget::ImreadLessonWidget(QWidget *parent)
     : QWidget(parent)
@@ -46,33 +48,66 @@ ImreadLessonWidget::ImreadLessonWidget(QWidget *parent)
     layout->addLayout(buttonLayout);
     layout->addWidget(statusLabel);
 
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
+
     connect(reloadButton, &QPushButton::clicked, this, [this]() {
         loadAndShowImage();
     });
     connect(showNormalButton, &QPushButton::clicked, this, [this]() {
         if (!correctImage.isNull())
         {
+            TRACE_SCOPE("QPixmap::fromImage");
             imageLabel->setPixmap(QPixmap::fromImage(correctImage));
             statusLabel->setText(statusText + QStringLiteral("\n当前显示：正常 step"));
+            showingWrongStep = false;
         }
     });
     connect(showWrongStepButton, &QPushButton::clicked, this, [this]() {
         if (!wrongStepImage.isNull())
         {
+            TRACE_SCOPE("QPixmap::fromImage");
             imageLabel->setPixmap(QPixmap::fromImage(wrongStepImage));
             statusLabel->setText(statusText + QStringLiteral("\n当前显示：错误 step（错位示例）"));
+            showingWrongStep = true;
         }
     });
 
     loadAndShowImage();
 }
 
+void ImreadLessonWidget::suspend()
+{
+    // 两张 QImage 和 QLabel 里的 pixmap 各持有一份整图，挂起时全部释放，只留状态文字
+    correctImage = QImage();
+    wrongStepImage = QImage();
+    imageLabel->clear();
+    suspended = true;
+}
+
+void ImreadLessonWidget::resume()
+{
+    if (!suspended)
+    {
+        return;
+    }
+    suspended = false;
+    // 解码结果通常仍在 ImageCache 中，重建两张示意图只需几毫秒
+    const bool wrongStep = showingWrongStep;
+    imageLoader->load(QStringLiteral("cat.jpg"), cv::IMREAD_GRAYSCALE, [this, wrongStep](const LoadedImage &loaded) {
+        showLoadedImage(QStringLiteral("cat.jpg"), loaded.image);
+        if (wrongStep && !wrongStepImage.isNull())
+        {
+            imageLabel->setPixmap(QPixmap::fromImage(wrongStepImage));
+            statusLabel->setText(statusText + QStringLiteral("\n当前显示：错误 step（错位示例）"));
+            showingWrongStep = true;
+        }
+    });
+}
+
 void ImreadLessonWidget::loadAndShowImage()
 {
     const QString imagePath = QStringLiteral("cat.jpg");
-    const QString cwd = QDir::currentPath();
-    const QString absPath = QFileInfo(imagePath).absoluteFilePath();
-    const bool fileExists = QFileInfo::exists(absPath);
 
     // 原注释（保留）：
     // cv::Mat就是OpenCV中的图像数据结构，读图、处理、存图都离不开它。
@@ -82,7 +117,18 @@ void ImreadLessonWidget::loadAndShowImage()
     // cv::IMREAD_COLOR - 彩色图，忽略Alpha通道
 
     // 这里读取为灰度图，方便演示 step 设置错误导致的错位
-    const cv::Mat image = cv::imread(imagePath.toStdString(), cv::IMREAD_GRAYSCALE);
+    // 解码在后台线程进行（内部经 ImageCache 调用 cv::imread），完成后回到 GUI 线程显示
+    imageLoader->load(imagePath, cv::IMREAD_GRAYSCALE, [this, imagePath](const LoadedImage &loaded) {
+        showLoadedImage(imagePath, loaded.image);
+    });
+}
+
+void ImreadLessonWidget::showLoadedImage(const QString &imagePath, const cv::Mat &image)
+{
+    const QString cwd = QDir::currentPath();
+    const QString absPath = QFileInfo(imagePath).absoluteFilePath();
+    const bool fileExists = QFileInfo::exists(absPath);
+
     if (image.empty())
     {
         statusText = QStringLiteral("读取失败：%1\n工作目录：%2\n解析路径：%3\n文件存在：%4")
@@ -95,7 +141,7 @@ void ImreadLessonWidget::loadAndShowImage()
         return;
     }
 
-    const QImage qimage = matToQImage(image);
+    const QImage qimage = matToQImage(image, MatToQImageMode::Share);
     if (qimage.isNull())
     {
         QMessageBox::critical(this,
@@ -130,5 +176,7 @@ void ImreadLessonWidget::loadAndShowImage()
                      .arg(wrongBytesPerLine);
 
     statusLabel->setText(statusText + QStringLiteral("\n当前显示：正常 step"));
+    showingWrongStep = false;
+    TRACE_SCOPE("QPixmap::fromImage");
     imageLabel->setPixmap(QPixmap::fromImage(correctImage));
 }
@@ -4,13 +4,21 @@
 #include <QImage>
 #include <QString>
 
+#include <opencv2/core.hpp>
+
+#include "../lesson_lifecycle.h"
+
+class AsyncImageLoader;
 class QLabel;
 
-class ImreadLessonWidget : public QWidget
+class ImreadLessonWidget : public QWidget, public LessonLifecycle
 {
 public:
     explicit ImreadLessonWidget(QWidget *parent = nullptr);
 
+    void suspend() override;
+    void resume() override;
+
 private:
     QLabel *titleLabel = nullptr;
     QLabel *imageLabel = nullptr;
@@ -18,6 +26,10 @@ private:
     QImage correctImage;
     QImage wrongStepImage;
     QString statusText;
+    bool showingWrongStep = false;
+    bool suspended = false;
+    AsyncImageLoader *imageLoader = nullptr;
 
     void loadAndShowImage();
+    void showLoadedImage(const QString &imagePath, const cv::Mat &image);
 };
@@ -5,11 +5,20 @@
 #include <QMetaObject>
 #include <QPushButton>
 #include <QSlider>
-#include <QTimer>
 #include <QVBoxLayout>
 
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../highgui_pump.h"
+#include "../image_cache.h"
+#include "../trace.h"
+
+namespace
+{
+const QString kImagePath = QStringLiteral("cat.jpg");
+} // namespace
+
 // 提取 OpenCV 构建信息中的 GUI 后端信息
 static QString extractGuiBackend()
 {
@@ -124,11 +133,8 @@ NamedWindowLessonWidget::NamedWindowLessonWidget(QWidget *parent)
     layout->addLayout(brushLayout);
     layout->addWidget(statusLabel);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
 
     connect(openButton, &QPushButton::clicked, this, &NamedWindowLessonWidget::openAndShow);
     connect(clearButton, &QPushButton::clicked, this, &NamedWindowLessonWidget::resetCanvas);
@@ -148,9 +154,21 @@ NamedWindowLessonWidget::NamedWindowLessonWidget(QWidget *parent)
 
 void NamedWindowLessonWidget::openAndShow()
 {
-    const QString imagePath = QStringLiteral("cat.jpg");
+    const QString imagePath = kImagePath;
     // 使用 IMREAD_UNCHANGED 以保留图像的原始通道和深度
-    originalImage = cv::imread(imagePath.toStdString(), cv::IMREAD_UNCHANGED);
+    // 画布上的笔迹画在原图坐标上，不使用低分辨率预览，避免切换到全分辨率时丢失
+    imageLoader->load(
+        imagePath,
+        cv::IMREAD_UNCHANGED,
+        [this, imagePath](const LoadedImage &loaded) {
+            showImage(imagePath, loaded.image);
+        },
+        AsyncImageLoader::Preview::None);
+}
+
+void NamedWindowLessonWidget::showImage(const QString &imagePath, const cv::Mat &image)
+{
+    originalImage = image;
     if (originalImage.empty())
     {
         statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
@@ -158,24 +176,96 @@ void NamedWindowLessonWidget::openAndShow()
     }
 
     displayImage = originalImage.clone();
+    showWindow();
+}
 
+void NamedWindowLessonWidget::showWindow()
+{
     windowName = "OpenCV namedWindow";
     cv::namedWindow(windowName, cv::WINDOW_NORMAL);
     cv::resizeWindow(windowName, 432, 648);
     // cv::imshow 会自动创建窗口，但这里为了演示 namedWindow，先调用它
     // cv::namedWindow是OpenCV中用于创建一个窗口以显示图像的函数，它底层使用系统原生的GUI能力，比如X11/GTK等后端之一。
-    cv::imshow(windowName, displayImage);
+    {
+        TRACE_SCOPE("imshow");
+        cv::imshow(windowName, displayImage);
+    }
 
     // 设置鼠标回调以捕获鼠标事件
     cv::setMouseCallback(windowName, onMouseCallback, this);
 
+    // 交给共享事件泵：Qt 后端由应用事件循环直接处理，其他后端定时调用 waitKey，窗口关闭后自动停止
+    HighGuiPump &pump = HighGuiPump::instance();
+    pump.watchWindow(windowName);
+    const QString pumpMode = pump.usesQtEventLoop() ? QStringLiteral("事件泵：Qt 事件循环（无轮询）")
+                                                    : QStringLiteral("事件泵：共享 waitKey 定时器（窗口全部关闭后停止）");
+
     // 提取并显示 GUI 后端信息
     const QString guiBackend = extractGuiBackend();
-    baseStatusText = QStringLiteral("已在 OpenCV 窗口显示：%1\n%2").arg(imagePath, guiBackend);
+    baseStatusText = QStringLiteral("已在 OpenCV 窗口显示：%1\n%2\n%3").arg(kImagePath, guiBackend, pumpMode);
     statusLabel->setText(baseStatusText);
-    if (!waitKeyTimer->isActive())
+}
+
+void NamedWindowLessonWidget::activate()
+{
+    if (reopenWindow && !displayImage.empty())
     {
-        waitKeyTimer->start();
+        showWindow();
+    }
+    reopenWindow = false;
+}
+
+void NamedWindowLessonWidget::deactivate()
+{
+    // 窗口不随页面隐藏，留着它会继续占用事件泵；关掉，回来时用保留的画布重新打开
+    isDrawing = false;
+    if (windowName.empty())
+    {
+        return;
+    }
+    reopenWindow = HighGuiPump::isWindowOpen(windowName);
+    HighGuiPump::instance().closeWindow(windowName);
+}
+
+void NamedWindowLessonWidget::suspend()
+{
+    if (displayImage.empty())
+    {
+        return;
+    }
+    // 笔迹只存在于画布上，用无损的 PNG 保存；原图由 ImageCache 共享，放掉引用即可
+    {
+        TRACE_SCOPE("suspend encode");
+        cv::imencode(".png", displayImage, suspendedCanvas);
+    }
+    displayImage.release();
+    originalImage.release();
+}
+
+void NamedWindowLessonWidget::resume()
+{
+    if (suspendedCanvas.empty())
+    {
+        return;
+    }
+    {
+        TRACE_SCOPE("resume decode");
+        displayImage = cv::imdecode(suspendedCanvas, cv::IMREAD_UNCHANGED);
+    }
+    suspendedCanvas.clear();
+    suspendedCanvas.shrink_to_fit();
+
+    // “清空画布”要用到原图：仍在缓存中时直接取回，否则在后台重新读取
+    originalImage = ImageCache::instance().lookup(kImagePath, cv::IMREAD_UNCHANGED);
+    if (originalImage.empty())
+    {
+        imageLoader->load(
+            kImagePath,
+            cv::IMREAD_UNCHANGED,
+            [this](const LoadedImage &loaded) {
+                originalImage = loaded.image;
+            },
+            AsyncImageLoader::Preview::None);
     }
 }
 
@@ -198,7 +288,9 @@ void NamedWindowLessonWidget::resetCanvas()
         return;
     }
 
-    displayImage = originalImage.clone();
+    // 尺寸不变时写回原缓冲区，不再每次 clone 出新图
+    originalImage.copyTo(displayImage);
+    TRACE_SCOPE("imshow");
     cv::imshow(windowName, displayImage);
 }
 
@@ -216,6 +308,11 @@ void NamedWindowLessonWidget::handleMouseEvent(int event, int x, int y, int flag
     // 当左键按下时开始绘图
     if (event == cv::EVENT_LBUTTONDOWN)
     {
+        // HighGUI 窗口的输入不一定经过 Qt 事件过滤器，在这里标记交互开始
+        if (trace::isEnabled())
+        {
+            trace::markInteraction();
+        }
         isDrawing = true;
         lastPoint = currentPoint;
         return;
@@ -230,6 +327,7 @@ void NamedWindowLessonWidget::handleMouseEvent(int event, int x, int y, int flag
             // 各个参数依次为：图像、起点、终点、颜色、粗细、线型，cv::line会直接修改displayImage的Mat数据，无法恢复。
             cv::line(displayImage, lastPoint, currentPoint, brushColor, brushThickness, cv::LINE_AA);
             lastPoint = currentPoint;
+            TRACE_SCOPE("imshow");
             cv::imshow(windowName, displayImage);
         }
         return;
@@ -4,24 +4,32 @@
 
 #include <QString>
 #include <string>
+#include <vector>
 
 #include <opencv2/opencv.hpp>
 
+#include "../lesson_lifecycle.h"
+
+class AsyncImageLoader;
 class QLabel;
-class QTimer;
 class QSlider;
 
-class NamedWindowLessonWidget : public QWidget
+class NamedWindowLessonWidget : public QWidget, public LessonLifecycle
 {
 public:
     explicit NamedWindowLessonWidget(QWidget *parent = nullptr);
     void updateMouseStatus(const QString &mouseText);
     void handleMouseEvent(int event, int x, int y, int flags);
 
+    void activate() override;
+    void deactivate() override;
+    void suspend() override;
+    void resume() override;
+
 private:
     QLabel *titleLabel = nullptr;
     QLabel *statusLabel = nullptr;
-    QTimer *waitKeyTimer = nullptr;
+    AsyncImageLoader *imageLoader = nullptr;
     QSlider *thicknessSlider = nullptr;
     std::string windowName;
     QString baseStatusText;
@@ -31,7 +39,13 @@ private:
     cv::Point lastPoint;
     cv::Scalar brushColor = cv::Scalar(0, 0, 255, 255);
     int brushThickness = 2;
+    // 离开页面时窗口是打开的，回来时重新打开
+    bool reopenWindow = false;
+    // 挂起时画布（含笔迹）的 PNG 编码
+    std::vector<uchar> suspendedCanvas;
 
     void openAndShow();
+    void showImage(const QString &imagePath, const cv::Mat &image);
+    void showWindow();
     void resetCanvas();
 };
@@ -1,97 +1,278 @@
 #include "morphology_trackbar_lesson_widget.h"
 
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QTimer>
 #include <QVBoxLayout>
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../fast_morphology.h"
+#include "../highgui_pump.h"
+#include "../image_cache.h"
+#include "../processing_worker.h"
+#include "../trace.h"
+
 namespace
 {
-struct MorphologyState
+// 流水线中的一个阶段：记录上次计算时的输入（上游版本号 + 本阶段参数），
+// 输入没变就直接复用 output；重新计算时尽量写回原有缓冲区
+struct MorphologyStage
+{
+    cv::Mat output;
+    int version = 0;
+    int upstreamVersion = -1;
+    int parameter = -1;
+
+    bool needsUpdate(int upstream, int param) const
+    {
+        return upstream != upstreamVersion || param != parameter;
+    }
+
+    void markUpdated(int upstream, int param)
+    {
+        upstreamVersion = upstream;
+        parameter = param;
+        ++version;
+    }
+
+    // 计算到一半被取消：output 里是不完整的结果，下次无论参数是否相同都要重算
+    void invalidate()
+    {
+        upstreamVersion = -1;
+        parameter = -1;
+    }
+
+    // 上一次是直接引用上游结果（参数为 0）时，或上次的结果还在界面线程排队显示时，
+    // 先断开共享，避免改掉别人正在用的图像
+    cv::Mat &writableOutput(const cv::Mat &upstream)
+    {
+        if (output.data == upstream.data || (output.u && output.u->refcount > 1))
+        {
+            output.release();
+        }
+        return output;
+    }
+};
+
+// 阶段缓存：原图 → 按模式转换 → 腐蚀 → 膨胀，只重算输入变化了的阶段。只在处理线程里访问
+struct MorphologyStages
+{
+    MorphologyStage base;
+    MorphologyStage eroded;
+    MorphologyStage dilated;
+};
+
+// 提交给处理线程的一份参数快照
+struct MorphologyParams
+{
+    cv::Mat original;
+    int sourceVersion = 0; // 原图的版本；会话内原图不变，始终为 0
+    int erodeSize = 0;
+    int dilateSize = 0;
+    int mode = 0;
+};
+} // namespace
+
+// 一幅打开的图像：自己的原图、阶段缓存、处理线程和 HighGUI 窗口。
+// 多幅图像各自独立，可以同时在不同核上处理
+struct MorphologySession
 {
+    QString imagePath;  // 图像路径，挂起后按它恢复
     cv::Mat original;   // 原始图像
-    cv::Mat display;    // 显示的图像
     std::string windowName; // 窗口名称
     int erodeSize = 0;  // 腐蚀大小
     int dilateSize = 0; // 膨胀大小
     int mode = 0; // 0: 彩色 1: 灰度 2: 二值
-};
 
-MorphologyState *gState = nullptr;
+    std::shared_ptr<MorphologyStages> stages = std::make_shared<MorphologyStages>();
+    std::unique_ptr<ProcessingWorker> worker = std::make_unique<ProcessingWorker>(nullptr);
+    std::function<void()> onPresented; // 结果显示后在界面线程调用，用来刷新状态栏
 
-void applyMorphology(MorphologyState *state)
-{
-    if (!state || state->original.empty())
+    ~MorphologySession()
     {
-        return;
+        // 先停下处理线程（不会再有结果送达），再关窗口
+        worker.reset();
+        HighGuiPump::instance().closeWindow(windowName);
     }
+};
+
+namespace
+{
+// 依次更新三个阶段；腐蚀/膨胀内部按行和列块检查取消，被更新的参数取消时返回空
+cv::Mat runMorphology(MorphologyStages &stages, const MorphologyParams &params, const CancelToken &token)
+{
+    const MorphCancel cancelled = [&token]() { return token.isCancelled(); };
 
     // 根据模式转换图像：0 彩色、1 灰度、2 二值
-    if (state->mode == 1)
+    MorphologyStage &base = stages.base;
+    if (base.needsUpdate(params.sourceVersion, params.mode))
     {
-        cv::cvtColor(state->original, state->display, cv::COLOR_BGR2GRAY);
+        if (params.mode == 1)
+        {
+            // 灰度图来自 ImageCache 的共享派生表示，后续阶段不会原地修改它
+            base.output = ImageCache::instance().derived(params.original, ImageCache::Derived::Gray);
+        }
+        else if (params.mode == 2)
+        {
+            const cv::Mat gray = ImageCache::instance().derived(params.original, ImageCache::Derived::Gray);
+            cv::threshold(gray, base.writableOutput(gray), 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        }
+        else
+        {
+            base.output = params.original;   // 彩色模式直接引用原图，后续阶段不会原地修改它
+        }
+        base.markUpdated(params.sourceVersion, params.mode);
     }
-    else if (state->mode == 2)
+
+    if (token.isCancelled())
     {
-        cv::Mat gray;
-        cv::cvtColor(state->original, gray, cv::COLOR_BGR2GRAY);
-        cv::threshold(gray, state->display, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        return cv::Mat();
     }
-    else
+
+    MorphologyStage &eroded = stages.eroded;
+    if (eroded.needsUpdate(base.version, params.erodeSize))
     {
-        state->display = state->original.clone();   // 重置为原始图像
+        if (params.erodeSize > 0)   // 应用腐蚀，它的效果是让亮区域(前景)变小，暗区域变大，能够去除小的白色噪点，分开连接在一起的物体。
+        {   
+            // 腐蚀核越大，图片越暗淡
+            const int k = params.erodeSize * 2 + 1; // 计算核大小
+            // 创建矩形结构元素作为腐蚀核，其中函数getStructuringElement的名字含义是“获取结构元素”，第一个参数指定形状，第二个参数指定大小。
+            cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
+            // 执行腐蚀操作，参数依次为：输入图像、输出图像、腐蚀核
+            // 把每个像素替换成其领域内的最小值，所以亮区域会变小，暗区域会变大。核越大，被替换的范围越大，效果越明显。
+            TRACE_SCOPE("erode");
+            fastErode(base.output, eroded.writableOutput(base.output), kernel, MorphBackend::Auto, cancelled);
+            if (token.isCancelled())
+            {
+                eroded.invalidate();
+                return cv::Mat();
+            }
+        }
+        else
+        {
+            eroded.output = base.output;
+        }
+        eroded.markUpdated(base.version, params.erodeSize);
     }
 
-    if (state->erodeSize > 0)   // 应用腐蚀，它的效果是让亮区域(前景)变小，暗区域变大，能够去除小的白色噪点，分开连接在一起的物体。
-    {   
-        // 腐蚀核越大，图片越暗淡
-        const int k = state->erodeSize * 2 + 1; // 计算核大小
-        // 创建矩形结构元素作为腐蚀核，其中函数getStructuringElement的名字含义是“获取结构元素”，第一个参数指定形状，第二个参数指定大小。
-        cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
-        // 执行腐蚀操作，参数依次为：输入图像、输出图像、腐蚀核
-        // 把每个像素替换成其领域内的最小值，所以亮区域会变小，暗区域会变大。核越大，被替换的范围越大，效果越明显。
-        cv::erode(state->display, state->display, kernel);
+    if (token.isCancelled())
+    {
+        return cv::Mat();
     }
 
-    if (state->dilateSize > 0)   // 应用膨胀，它的效果是让亮区域(前景)变大，暗区域变小，能够填补小的黑色孔洞，连接断开的物体。
+    MorphologyStage &dilated = stages.dilated;
+    if (dilated.needsUpdate(eroded.version, params.dilateSize))
     {
-        // 膨胀核越大，图片越明亮
-        const int k = state->dilateSize * 2 + 1; // 计算核大小
-        // 创建矩形结构元素作为膨胀核，其中函数getStructuringElement的名字含义是“获取结构元素”，第一个参数指定形状，第二个参数指定大小。
-        cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
-        // 执行膨胀操作，参数依次为：输入图像、输出图像、膨胀核
-        // 把每个像素替换成其领域内的最大值，所以亮区域会变大，暗区域会变小。核越大，被替换的范围越大，效果越明显。
-        cv::dilate(state->display, state->display, kernel);
+        if (params.dilateSize > 0)   // 应用膨胀，它的效果是让亮区域(前景)变大，暗区域变小，能够填补小的黑色孔洞，连接断开的物体。
+        {
+            // 膨胀核越大，图片越明亮
+            const int k = params.dilateSize * 2 + 1; // 计算核大小
+            // 创建矩形结构元素作为膨胀核，其中函数getStructuringElement的名字含义是“获取结构元素”，第一个参数指定形状，第二个参数指定大小。
+            cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
+            // 执行膨胀操作，参数依次为：输入图像、输出图像、膨胀核
+            // 把每个像素替换成其领域内的最大值，所以亮区域会变大，暗区域会变小。核越大，被替换的范围越大，效果越明显。
+            TRACE_SCOPE("dilate");
+            fastDilate(eroded.output, dilated.writableOutput(eroded.output), kernel, MorphBackend::Auto, cancelled);
+            if (token.isCancelled())
+            {
+                dilated.invalidate();
+                return cv::Mat();
+            }
+        }
+        else
+        {
+            dilated.output = eroded.output;
+        }
+        dilated.markUpdated(eroded.version, params.dilateSize);
     }
 
-    cv::imshow(state->windowName, state->display);   // 显示处理后的图像
+    return dilated.output;
+}
+
+// 滑动条回调在 waitKey 里同步触发：这里只提交参数快照，由处理线程计算，
+// 拖动过程中未开始的旧参数会被新值替换，只有最新结果会显示
+void applyMorphology(MorphologySession *session)
+{
+    if (!session || session->original.empty())
+    {
+        return;
+    }
+
+    MorphologyParams params;
+    params.original = session->original;
+    params.erodeSize = session->erodeSize;
+    params.dilateSize = session->dilateSize;
+    params.mode = session->mode;
+
+    const std::shared_ptr<MorphologyStages> stages = session->stages;
+    const std::string windowName = session->windowName;
+    // 呈现函数只会在 worker 存活时执行，而 worker 随会话一起销毁，所以这里可以直接引用会话
+    session->worker->submit([session, stages, params, windowName](const CancelToken &token) -> ProcessingWorker::Present {
+        const cv::Mat display = runMorphology(*stages, params, token);
+        if (display.empty())
+        {
+            return nullptr;
+        }
+        return [session, display, windowName]() {
+            {
+                TRACE_SCOPE("imshow");
+                cv::imshow(windowName, display);   // 显示处理后的图像
+            }
+            if (session->onPresented)
+            {
+                session->onPresented();
+            }
+        };
+    });
 }
 
 // 回调函数：处理腐蚀滑动条变化
 void onErodeTrackbar(int value, void *userdata)
 {
-    auto *state = static_cast<MorphologyState *>(userdata);
-    if (!state)
+    auto *session = static_cast<MorphologySession *>(userdata);
+    if (!session)
     {
         return;
     }
-    state->erodeSize = value;
-    applyMorphology(state);
+    session->erodeSize = value;
+    applyMorphology(session);
 }
 
 // 回调函数：处理膨胀滑动条变化
 void onDilateTrackbar(int value, void *userdata)
 {
-    auto *state = static_cast<MorphologyState *>(userdata);
-    if (!state)
+    auto *session = static_cast<MorphologySession *>(userdata);
+    if (!session)
     {
         return;
     }
-    state->dilateSize = value;
-    applyMorphology(state);
+    session->dilateSize = value;
+    applyMorphology(session);
+}
+
+// 创建（或在重新进入页面时重新创建）会话的窗口和滑动条，滑动条初始位置取会话当前参数
+void openSessionWindow(MorphologySession *session)
+{
+    cv::namedWindow(session->windowName, cv::WINDOW_NORMAL);
+    cv::resizeWindow(session->windowName, 432, 648);
+    cv::imshow(session->windowName, session->original);
+
+    // 创建腐蚀和膨胀的滑动条，并关联回调函数
+    // 参数依次为：滑动条名称、窗口名称、变量地址、最大值、回调函数、用户数据
+    cv::createTrackbar("Erode", session->windowName, &session->erodeSize, 10, onErodeTrackbar, session);
+    cv::createTrackbar("Dilate", session->windowName, &session->dilateSize, 10, onDilateTrackbar, session);
+
+    // 初始应用一次形态学操作以显示效果
+    applyMorphology(session);
+    HighGuiPump::instance().watchWindow(session->windowName);
 }
 } // namespace
 
@@ -108,11 +289,13 @@ MorphologyTrackbarLessonWidget::MorphologyTrackbarLessonWidget(QWidget *parent)
 
     auto *buttonLayout = new QHBoxLayout();
     auto *openButton = new QPushButton(QStringLiteral("打开并显示"), this);
+    auto *openFileButton = new QPushButton(QStringLiteral("打开文件…"), this);
     auto *colorButton = new QPushButton(QStringLiteral("彩色图"), this);
     auto *grayButton = new QPushButton(QStringLiteral("灰度图"), this);
     auto *binaryButton = new QPushButton(QStringLiteral("二值图"), this);
     buttonLayout->addStretch();
     buttonLayout->addWidget(openButton);
+    buttonLayout->addWidget(openFileButton);
     buttonLayout->addWidget(colorButton);
     buttonLayout->addWidget(grayButton);
     buttonLayout->addWidget(binaryButton);
@@ -122,66 +305,171 @@ MorphologyTrackbarLessonWidget::MorphologyTrackbarLessonWidget(QWidget *parent)
     layout->addLayout(buttonLayout);
     layout->addWidget(statusLabel);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
+    imageLoader->setPrecompute({ImageCache::Derived::Gray});
 
     connect(openButton, &QPushButton::clicked, this, &MorphologyTrackbarLessonWidget::openAndShow);
-    connect(colorButton, &QPushButton::clicked, this, []() {
-        if (gState)
-        {
-            gState->mode = 0;
-            applyMorphology(gState);
-        }
-    });
-    connect(grayButton, &QPushButton::clicked, this, []() {
-        if (gState)
-        {
-            gState->mode = 1;
-            applyMorphology(gState);
-        }
-    });
-    connect(binaryButton, &QPushButton::clicked, this, []() {
-        if (gState)
+    connect(openFileButton, &QPushButton::clicked, this, &MorphologyTrackbarLessonWidget::openFile);
+    // 模式按钮作用于最近打开的那幅图像
+    connect(colorButton, &QPushButton::clicked, this, [this]() { setActiveMode(0); });
+    connect(grayButton, &QPushButton::clicked, this, [this]() { setActiveMode(1); });
+    connect(binaryButton, &QPushButton::clicked, this, [this]() { setActiveMode(2); });
+}
+
+MorphologyTrackbarLessonWidget::~MorphologyTrackbarLessonWidget() = default;
+
+void MorphologyTrackbarLessonWidget::activate()
+{
+    if (windowsHidden)
+    {
+        for (const std::unique_ptr<MorphologySession> &session : sessions)
         {
-            gState->mode = 2;
-            applyMorphology(gState);
+            openSessionWindow(session.get());
         }
+        windowsHidden = false;
+    }
+    // 上次恢复到一半就离开了页面（读取被取消），继续恢复剩下的会话
+    if (!imageLoader->isLoading())
+    {
+        restoreNextSession();
+    }
+}
+
+void MorphologyTrackbarLessonWidget::deactivate()
+{
+    // 用户已经关掉窗口的会话不再需要；其余的停下处理线程、关掉窗口，但保留原图和阶段缓存，
+    // 很快切回来时重新打开窗口即可，不必重新计算
+    sessions.erase(std::remove_if(sessions.begin(),
+                                  sessions.end(),
+                                  [](const std::unique_ptr<MorphologySession> &session) {
+                                      return !HighGuiPump::isWindowOpen(session->windowName);
+                                  }),
+                   sessions.end());
+    for (const std::unique_ptr<MorphologySession> &session : sessions)
+    {
+        session->worker->cancel();
+        HighGuiPump::instance().closeWindow(session->windowName);
+    }
+    windowsHidden = !sessions.empty();
+}
+
+void MorphologyTrackbarLessonWidget::suspend()
+{
+    // 阶段缓存和处理线程随会话一起销毁，只留下路径和参数
+    for (const std::unique_ptr<MorphologySession> &session : sessions)
+    {
+        suspendedSessions.push_back({session->imagePath, session->erodeSize, session->dilateSize, session->mode});
+    }
+    sessions.clear();
+    windowsHidden = false;
+}
+
+void MorphologyTrackbarLessonWidget::resume()
+{
+    restoreNextSession();
+}
+
+void MorphologyTrackbarLessonWidget::restoreNextSession()
+{
+    if (suspendedSessions.empty())
+    {
+        return;
+    }
+    // 读取器同一时间只保留一个请求，逐个恢复：每个会话显示后再读取下一个
+    const QString imagePath = suspendedSessions.front().imagePath;
+    imageLoader->load(imagePath, cv::IMREAD_UNCHANGED, [this, imagePath](const LoadedImage &loaded) {
+        const SuspendedSession restore = suspendedSessions.front();
+        suspendedSessions.erase(suspendedSessions.begin());
+        showImage(imagePath, loaded.image, &restore);
+        restoreNextSession();
     });
 }
 
 void MorphologyTrackbarLessonWidget::openAndShow()
 {
-    // 使用静态变量以保持状态，避免每次调用都重新创建
-    static MorphologyState state;
-    gState = &state;
+    loadImage(QStringLiteral("cat.jpg"));
+}
 
-    const QString imagePath = QStringLiteral("cat.jpg");
-    state.original = cv::imread(imagePath.toStdString(), cv::IMREAD_UNCHANGED);
-    if (state.original.empty())
+void MorphologyTrackbarLessonWidget::openFile()
+{
+    const QString imagePath = QFileDialog::getOpenFileName(this,
+                                                           QStringLiteral("选择图片"),
+                                                           QString(),
+                                                           QStringLiteral("图片 (*.jpg *.jpeg *.png *.bmp *.webp *.tif *.tiff)"));
+    if (!imagePath.isEmpty())
+    {
+        loadImage(imagePath);
+    }
+}
+
+void MorphologyTrackbarLessonWidget::loadImage(const QString &imagePath)
+{
+    imageLoader->load(imagePath, cv::IMREAD_UNCHANGED, [this, imagePath](const LoadedImage &loaded) {
+        showImage(imagePath, loaded.image);
+    });
+}
+
+void MorphologyTrackbarLessonWidget::showImage(const QString &imagePath, const cv::Mat &image, const SuspendedSession *restore)
+{
+    if (image.empty())
     {
         statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
         return;
     }
 
-    state.windowName = "OpenCV Morphology Trackbar";
-    cv::namedWindow(state.windowName, cv::WINDOW_NORMAL);
-    cv::resizeWindow(state.windowName, 432, 648);
-    cv::imshow(state.windowName, state.original);
+    // 用户已经关掉窗口的会话不再需要
+    sessions.erase(std::remove_if(sessions.begin(),
+                                  sessions.end(),
+                                  [](const std::unique_ptr<MorphologySession> &session) {
+                                      return !HighGuiPump::isWindowOpen(session->windowName);
+                                  }),
+                   sessions.end());
 
-    // 创建腐蚀和膨胀的滑动条，并关联回调函数
-    // 参数依次为：滑动条名称、窗口名称、变量地址、最大值、回调函数、用户数据
-    cv::createTrackbar("Erode", state.windowName, &state.erodeSize, 10, onErodeTrackbar, &state);
-    cv::createTrackbar("Dilate", state.windowName, &state.dilateSize, 10, onDilateTrackbar, &state);
+    auto session = std::make_unique<MorphologySession>();
+    session->imagePath = imagePath;
+    session->original = image;
+    if (restore)
+    {
+        session->erodeSize = restore->erodeSize;
+        session->dilateSize = restore->dilateSize;
+        session->mode = restore->mode;
+    }
+    session->windowName = QStringLiteral("Morphology #%1 - %2")
+                              .arg(++sessionCounter)
+                              .arg(QFileInfo(imagePath).fileName())
+                              .toStdString();
+    MorphologySession *current = session.get();
+    session->onPresented = [this, current]() { showSessionStats(*current); };
+    openSessionWindow(session.get());
 
-    // 初始应用一次形态学操作以显示效果
-    applyMorphology(&state);
+    statusLabel->setText(QStringLiteral("已显示：%1（共 %2 幅）\n拖动滑动条控制腐蚀/膨胀，每幅图像在自己的线程里处理")
+                             .arg(imagePath)
+                             .arg(sessions.size() + 1));
+    sessions.push_back(std::move(session));
+}
 
-    statusLabel->setText(QStringLiteral("已显示：%1\n拖动滑动条控制腐蚀/膨胀").arg(imagePath));
-    if (!waitKeyTimer->isActive())
+void MorphologyTrackbarLessonWidget::setActiveMode(int mode)
+{
+    if (sessions.empty())
     {
-        waitKeyTimer->start();
+        return;
     }
+    MorphologySession *session = sessions.back().get();
+    session->mode = mode;
+    applyMorphology(session);
+}
+
+void MorphologyTrackbarLessonWidget::showSessionStats(const MorphologySession &session)
+{
+    const ProcessingWorker::Stats stats = session.worker->stats();
+    statusLabel->setText(QStringLiteral("%1：腐蚀 %2，膨胀 %3（共 %4 幅）\n"
+                                        "处理任务：完成 %5，丢弃 %6，取消 %7")
+                             .arg(QString::fromStdString(session.windowName))
+                             .arg(session.erodeSize)
+                             .arg(session.dilateSize)
+                             .arg(sessions.size())
+                             .arg(stats.completed)
+                             .arg(stats.dropped)
+                             .arg(stats.cancelled));
 }
@@ -2,18 +2,53 @@
 
 #include <QWidget>
 
+#include <opencv2/core.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../lesson_lifecycle.h"
+
+class AsyncImageLoader;
 class QLabel;
-class QTimer;
+struct MorphologySession;
 
-class MorphologyTrackbarLessonWidget : public QWidget
+class MorphologyTrackbarLessonWidget : public QWidget, public LessonLifecycle
 {
 public:
     explicit MorphologyTrackbarLessonWidget(QWidget *parent = nullptr);
+    ~MorphologyTrackbarLessonWidget() override;
+
+    void activate() override;
+    void deactivate() override;
+    void suspend() override;
+    void resume() override;
 
 private:
+    // 挂起的会话只保留图像路径和滑动条/模式参数，恢复时重新读取（通常命中 ImageCache）并重建
+    struct SuspendedSession
+    {
+        QString imagePath;
+        int erodeSize = 0;
+        int dilateSize = 0;
+        int mode = 0;
+    };
+
     QLabel *titleLabel = nullptr;
     QLabel *statusLabel = nullptr;
-    QTimer *waitKeyTimer = nullptr;
+    AsyncImageLoader *imageLoader = nullptr;
+    // 每幅打开的图像一个会话，各自持有状态、缓冲区、处理线程和窗口
+    std::vector<std::unique_ptr<MorphologySession>> sessions;
+    int sessionCounter = 0;
+    std::vector<SuspendedSession> suspendedSessions;
+    bool windowsHidden = false;
 
     void openAndShow();
+    void openFile();
+    void loadImage(const QString &imagePath);
+    void showImage(const QString &imagePath, const cv::Mat &image, const SuspendedSession *restore = nullptr);
+    void restoreNextSession();
+    void setActiveMode(int mode);
+    // 在状态栏显示该会话的参数和处理线程统计（完成/丢弃/取消）
+    void showSessionStats(const MorphologySession &session);
 };
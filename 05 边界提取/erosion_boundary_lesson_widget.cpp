@@ -1,50 +1,251 @@
 #include "erosion_boundary_lesson_widget.h"
 
+#include <QCheckBox>
+#include <QCoreApplication>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QPointer>
 #include <QPushButton>
-#include <QTimer>
+#include <QThreadPool>
 #include <QVBoxLayout>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../fast_morphology.h"
+#include "../highgui_pump.h"
+#include "../image_cache.h"
+#include "../memory_accounting.h"
+#include "../trace.h"
+
 namespace
 {
-struct BoundaryState
+constexpr int kMaxErodeSize = 10;
+// 按位压缩时，灰度差 ≥ 该值的像素记为边界
+constexpr int kPackedThreshold = 32;
+
+// 腐蚀尺寸 1..10 的边界尺度空间：加载后在后台逐级生成，滑动条只需查表显示
+struct BoundaryScaleSpace
 {
-    cv::Mat original;
-    cv::Mat gray;
+    bool packed = false;
+    cv::Size size;
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    std::array<cv::Mat, kMaxErodeSize> levels; // levels[k - 1] 为尺寸 k 的边界
+    int ready = 0;
+    size_t bytes = 0;
+};
+
+// 每 8 个像素压成一个字节（高位在前）
+cv::Mat packBits(const cv::Mat &boundary)
+{
+    cv::Mat packed(boundary.rows, (boundary.cols + 7) / 8, CV_8UC1, cv::Scalar(0));
+    for (int y = 0; y < boundary.rows; ++y)
+    {
+        const uchar *in = boundary.ptr<uchar>(y);
+        uchar *out = packed.ptr<uchar>(y);
+        for (int x = 0; x < boundary.cols; ++x)
+        {
+            if (in[x] >= kPackedThreshold)
+            {
+                out[x >> 3] |= static_cast<uchar>(0x80 >> (x & 7));
+            }
+        }
+    }
+    return packed;
+}
+
+void unpackBits(const cv::Mat &packed, const cv::Size &size, cv::Mat &out)
+{
+    out.create(size, CV_8UC1);
+    for (int y = 0; y < size.height; ++y)
+    {
+        const uchar *in = packed.ptr<uchar>(y);
+        uchar *row = out.ptr<uchar>(y);
+        for (int x = 0; x < size.width; ++x)
+        {
+            row[x] = (in[x >> 3] & (0x80 >> (x & 7))) ? 255 : 0;
+        }
+    }
+}
+
+// 已生成时返回尺寸 k 的边界，按位压缩的先解到 unpackBuffer；尚未生成时返回空
+cv::Mat lookupBoundary(BoundaryScaleSpace &space, int k, cv::Mat &unpackBuffer)
+{
+    cv::Mat level;
+    {
+        std::lock_guard<std::mutex> lock(space.mutex);
+        level = space.levels[static_cast<size_t>(k - 1)];
+    }
+    if (level.empty() || !space.packed)
+    {
+        return level;
+    }
+    unpackBits(level, space.size, unpackBuffer);
+    return unpackBuffer;
+}
+
+QString describeScaleSpace(BoundaryScaleSpace &space)
+{
+    std::lock_guard<std::mutex> lock(space.mutex);
+    return QStringLiteral("尺度空间：已生成 %1/%2 级，占用 %3 MB（%4）")
+        .arg(space.ready)
+        .arg(kMaxErodeSize)
+        .arg(static_cast<double>(space.bytes) / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(space.packed ? QStringLiteral("按位压缩的二值边界") : QStringLiteral("每像素 8 位"));
+}
+
+// 后台逐级生成：(2k+1)x(2k+1) 的矩形是 k 个 3x3 矩形的闵可夫斯基和，
+// 所以尺寸 k 的腐蚀只需在尺寸 k-1 的结果上再做一次 3x3 腐蚀
+void buildScaleSpace(const std::shared_ptr<BoundaryScaleSpace> &space,
+                     const cv::Mat &gray,
+                     const std::function<void()> &onLevelReady)
+{
+    const cv::Mat step = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
     cv::Mat eroded;
+    cv::Mat next;
+    for (int k = 1; k <= kMaxErodeSize && !space->cancelled; ++k)
+    {
+        TRACE_SCOPE("scale-space level");
+        cv::erode(k == 1 ? gray : eroded, next, step);
+        std::swap(eroded, next);
+        // 腐蚀结果不大于原图，差值即边界
+        cv::Mat boundary;
+        cv::subtract(gray, eroded, boundary);
+
+        const cv::Mat level = space->packed ? packBits(boundary) : boundary;
+        {
+            std::lock_guard<std::mutex> lock(space->mutex);
+            space->bytes += level.total() * level.elemSize();
+            space->levels[static_cast<size_t>(k - 1)] = level;
+            space->ready = k;
+        }
+        onLevelReady();
+    }
+}
+
+} // namespace
+
+// 一幅打开的图像：自己的灰度图、尺度空间、显示缓冲区和 HighGUI 窗口。
+// 多幅图像的尺度空间各自在线程池里并行生成
+struct BoundarySession
+{
+    QString imagePath;
+    cv::Mat gray;
     cv::Mat boundary;
+    cv::Mat unpacked;
     std::string windowName;
     int erodeSize = 1;
+    bool packed = false;
+    std::shared_ptr<BoundaryScaleSpace> scaleSpace;
+
+    ~BoundarySession()
+    {
+        if (scaleSpace)
+        {
+            scaleSpace->cancelled = true;
+        }
+        HighGuiPump::instance().closeWindow(windowName);
+    }
 };
 
-void updateBoundary(BoundaryState *state)
+namespace
+{
+void updateBoundary(BoundarySession *state)
 {
     if (!state || state->gray.empty())
     {
         return;
     }
 
+    if (state->scaleSpace)
+    {
+        const cv::Mat cached = lookupBoundary(*state->scaleSpace, state->erodeSize, state->unpacked);
+        if (!cached.empty())
+        {
+            TRACE_SCOPE("imshow");
+            cv::imshow(state->windowName, cached);
+            return;
+        }
+    }
+
+    // 该级还没生成时直接计算：腐蚀与相减在同一遍分块完成，不生成整幅腐蚀图
     const int k = state->erodeSize * 2 + 1;
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
-    cv::erode(state->gray, state->eroded, kernel);
-    cv::absdiff(state->gray, state->eroded, state->boundary);
+    {
+        TRACE_SCOPE("morphGradient");
+        morphGradient(state->gray, state->boundary, kernel, MorphGradient::Internal);
+    }
+    if (state->packed)
+    {
+        cv::threshold(state->boundary, state->boundary, kPackedThreshold - 1, 255, cv::THRESH_BINARY);
+    }
 
+    TRACE_SCOPE("imshow");
     cv::imshow(state->windowName, state->boundary);
 }
 
+// 取消旧的尺度空间并在线程池里重新生成，每生成一级就在状态栏报告进度和内存占用
+void startScaleSpace(BoundarySession &state, QLabel *statusLabel)
+{
+    if (state.scaleSpace)
+    {
+        state.scaleSpace->cancelled = true;
+    }
+
+    auto space = std::make_shared<BoundaryScaleSpace>();
+    space->packed = state.packed;
+    space->size = state.gray.size();
+    state.scaleSpace = space;
+
+    const cv::Mat gray = state.gray;
+    const QPointer<QLabel> label = statusLabel;
+    const QString windowName = QString::fromStdString(state.windowName);
+    const int lesson = memory_accounting::currentLesson();
+    QThreadPool::globalInstance()->start([space, gray, label, windowName, lesson]() {
+        memory_accounting::Scope tag(lesson, "scale-space");
+        buildScaleSpace(space, gray, [space, label, windowName]() {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [space, label, windowName]() {
+                if (label && !space->cancelled)
+                {
+                    label->setText(QStringLiteral("%1\n%2").arg(windowName, describeScaleSpace(*space)));
+                }
+            }, Qt::QueuedConnection);
+        });
+    });
+}
+
 void onErodeTrackbar(int value, void *userdata)
 {
-    auto *state = static_cast<BoundaryState *>(userdata);
+    auto *state = static_cast<BoundarySession *>(userdata);
     if (!state)
     {
         return;
     }
-    state->erodeSize = std::max(1, value);
+    state->erodeSize = std::clamp(value, 1, kMaxErodeSize);
     updateBoundary(state);
 }
+
+// 创建（或在重新进入页面时重新创建）会话的窗口和滑动条
+void openSessionWindow(BoundarySession *session)
+{
+    cv::namedWindow(session->windowName, cv::WINDOW_NORMAL);
+    cv::resizeWindow(session->windowName, 432, 648);
+
+    cv::createTrackbar("Erode", session->windowName, &session->erodeSize, kMaxErodeSize, onErodeTrackbar, session);
+
+    updateBoundary(session);
+    HighGuiPump::instance().watchWindow(session->windowName);
+}
 } // namespace
 
 ErosionBoundaryLessonWidget::ErosionBoundaryLessonWidget(QWidget *parent)
@@ -60,59 +261,173 @@ ErosionBoundaryLessonWidget::ErosionBoundaryLessonWidget(QWidget *parent)
 
     auto *buttonLayout = new QHBoxLayout();
     auto *openButton = new QPushButton(QStringLiteral("打开并显示"), this);
+    auto *openFileButton = new QPushButton(QStringLiteral("打开文件…"), this);
+    auto *packedCheck = new QCheckBox(QStringLiteral("按位压缩存储（二值边界）"), this);
     buttonLayout->addStretch();
     buttonLayout->addWidget(openButton);
+    buttonLayout->addWidget(openFileButton);
+    buttonLayout->addWidget(packedCheck);
     buttonLayout->addStretch();
 
     layout->addWidget(titleLabel);
     layout->addLayout(buttonLayout);
     layout->addWidget(statusLabel);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
+    imageLoader->setPrecompute({ImageCache::Derived::Gray});
 
     connect(openButton, &QPushButton::clicked, this, &ErosionBoundaryLessonWidget::openAndShow);
+    connect(openFileButton, &QPushButton::clicked, this, &ErosionBoundaryLessonWidget::openFile);
+    connect(packedCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        packedStorage = checked;
+        for (const std::unique_ptr<BoundarySession> &session : sessions)
+        {
+            session->packed = checked;
+            startScaleSpace(*session, statusLabel);
+            updateBoundary(session.get());
+        }
+    });
 }
 
-void ErosionBoundaryLessonWidget::openAndShow()
+ErosionBoundaryLessonWidget::~ErosionBoundaryLessonWidget() = default;
+
+void ErosionBoundaryLessonWidget::activate()
 {
-    static BoundaryState state;
+    if (windowsHidden)
+    {
+        for (const std::unique_ptr<BoundarySession> &session : sessions)
+        {
+            openSessionWindow(session.get());
+            // 离开时被叫停、尚未生成完的尺度空间重新生成
+            if (session->scaleSpace && session->scaleSpace->cancelled)
+            {
+                startScaleSpace(*session, statusLabel);
+            }
+        }
+        windowsHidden = false;
+    }
+    // 上次恢复到一半就离开了页面（读取被取消），继续恢复剩下的会话
+    if (!imageLoader->isLoading())
+    {
+        restoreNextSession();
+    }
+}
 
-    const QString imagePath = QStringLiteral("cat.jpg");
-    state.original = cv::imread(imagePath.toStdString(), cv::IMREAD_UNCHANGED);
-    if (state.original.empty())
+void ErosionBoundaryLessonWidget::deactivate()
+{
+    // 用户已经关掉窗口的会话不再需要；其余的叫停尚未完成的尺度空间、关掉窗口，保留灰度图和已生成的边界
+    sessions.erase(std::remove_if(sessions.begin(),
+                                  sessions.end(),
+                                  [](const std::unique_ptr<BoundarySession> &session) {
+                                      return !HighGuiPump::isWindowOpen(session->windowName);
+                                  }),
+                   sessions.end());
+    for (const std::unique_ptr<BoundarySession> &session : sessions)
     {
-        statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
-        return;
+        if (session->scaleSpace)
+        {
+            std::lock_guard<std::mutex> lock(session->scaleSpace->mutex);
+            if (session->scaleSpace->ready < kMaxErodeSize)
+            {
+                session->scaleSpace->cancelled = true;
+            }
+        }
+        HighGuiPump::instance().closeWindow(session->windowName);
     }
+    windowsHidden = !sessions.empty();
+}
 
-    if (state.original.channels() == 3)
+void ErosionBoundaryLessonWidget::suspend()
+{
+    // 尺度空间（最多 10 级边界）随会话一起释放，只留下路径和腐蚀尺寸
+    for (const std::unique_ptr<BoundarySession> &session : sessions)
     {
-        cv::cvtColor(state.original, state.gray, cv::COLOR_BGR2GRAY);
+        suspendedSessions.push_back({session->imagePath, session->erodeSize});
     }
-    else if (state.original.channels() == 4)
+    sessions.clear();
+    windowsHidden = false;
+}
+
+void ErosionBoundaryLessonWidget::resume()
+{
+    restoreNextSession();
+}
+
+void ErosionBoundaryLessonWidget::restoreNextSession()
+{
+    if (suspendedSessions.empty())
     {
-        cv::cvtColor(state.original, state.gray, cv::COLOR_BGRA2GRAY);
+        return;
     }
-    else
+    // 读取器同一时间只保留一个请求，逐个恢复：每个会话显示后再读取下一个
+    const QString imagePath = suspendedSessions.front().imagePath;
+    imageLoader->load(imagePath, cv::IMREAD_UNCHANGED, [this, imagePath](const LoadedImage &loaded) {
+        const SuspendedSession restore = suspendedSessions.front();
+        suspendedSessions.erase(suspendedSessions.begin());
+        showImage(imagePath, loaded.image, &restore);
+        restoreNextSession();
+    });
+}
+
+void ErosionBoundaryLessonWidget::openAndShow()
+{
+    loadImage(QStringLiteral("cat.jpg"));
+}
+
+void ErosionBoundaryLessonWidget::openFile()
+{
+    const QString imagePath = QFileDialog::getOpenFileName(this,
+                                                           QStringLiteral("选择图片"),
+                                                           QString(),
+                                                           QStringLiteral("图片 (*.jpg *.jpeg *.png *.bmp *.webp *.tif *.tiff)"));
+    if (!imagePath.isEmpty())
     {
-        state.gray = state.original.clone();
+        loadImage(imagePath);
     }
+}
 
-    state.windowName = "OpenCV Erosion Boundary";
-    cv::namedWindow(state.windowName, cv::WINDOW_NORMAL);
-    cv::resizeWindow(state.windowName, 432, 648);
+void ErosionBoundaryLessonWidget::loadImage(const QString &imagePath)
+{
+    imageLoader->load(imagePath, cv::IMREAD_UNCHANGED, [this, imagePath](const LoadedImage &loaded) {
+        showImage(imagePath, loaded.image);
+    });
+}
 
-    cv::createTrackbar("Erode", state.windowName, &state.erodeSize, 10, onErodeTrackbar, &state);
+void ErosionBoundaryLessonWidget::showImage(const QString &imagePath, const cv::Mat &image, const SuspendedSession *restore)
+{
+    if (image.empty())
+    {
+        statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
+        return;
+    }
 
-    updateBoundary(&state);
+    // 用户已经关掉窗口的会话不再需要
+    sessions.erase(std::remove_if(sessions.begin(),
+                                  sessions.end(),
+                                  [](const std::unique_ptr<BoundarySession> &session) {
+                                      return !HighGuiPump::isWindowOpen(session->windowName);
+                                  }),
+                   sessions.end());
 
-    statusLabel->setText(QStringLiteral("已显示边界：%1\n滑动 Erode 调整腐蚀核大小").arg(imagePath));
-    if (!waitKeyTimer->isActive())
+    auto session = std::make_unique<BoundarySession>();
+    session->imagePath = imagePath;
+    session->packed = packedStorage;
+    if (restore)
     {
-        waitKeyTimer->start();
+        session->erodeSize = restore->erodeSize;
     }
+    session->gray = ImageCache::instance().derived(image, ImageCache::Derived::Gray);
+
+    session->windowName = QStringLiteral("Erosion Boundary #%1 - %2")
+                              .arg(++sessionCounter)
+                              .arg(QFileInfo(imagePath).fileName())
+                              .toStdString();
+    openSessionWindow(session.get());
+
+    statusLabel->setText(QStringLiteral("已显示边界：%1（共 %2 幅）\n滑动 Erode 调整腐蚀核大小")
+                             .arg(imagePath)
+                             .arg(sessions.size() + 1));
+    startScaleSpace(*session, statusLabel);
+    sessions.push_back(std::move(session));
 }
@@ -2,18 +2,49 @@
 
 #include <QWidget>
 
+#include <opencv2/core.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../lesson_lifecycle.h"
+
+class AsyncImageLoader;
 class QLabel;
-class QTimer;
+struct BoundarySession;
 
-class ErosionBoundaryLessonWidget : public QWidget
+class ErosionBoundaryLessonWidget : public QWidget, public LessonLifecycle
 {
 public:
     explicit ErosionBoundaryLessonWidget(QWidget *parent = nullptr);
+    ~ErosionBoundaryLessonWidget() override;
+
+    void activate() override;
+    void deactivate() override;
+    void suspend() override;
+    void resume() override;
 
 private:
+    // 挂起的会话只保留图像路径和腐蚀尺寸，恢复时重新读取并重新生成尺度空间
+    struct SuspendedSession
+    {
+        QString imagePath;
+        int erodeSize = 1;
+    };
+
     QLabel *titleLabel = nullptr;
     QLabel *statusLabel = nullptr;
-    QTimer *waitKeyTimer = nullptr;
+    AsyncImageLoader *imageLoader = nullptr;
+    // 每幅打开的图像一个会话，各自持有灰度图、尺度空间和窗口
+    std::vector<std::unique_ptr<BoundarySession>> sessions;
+    int sessionCounter = 0;
+    bool packedStorage = false;
+    std::vector<SuspendedSession> suspendedSessions;
+    bool windowsHidden = false;
 
     void openAndShow();
+    void openFile();
+    void loadImage(const QString &imagePath);
+    void showImage(const QString &imagePath, const cv::Mat &image, const SuspendedSession *restore = nullptr);
+    void restoreNextSession();
 };
@@ -4,29 +4,56 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QSlider>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVBoxLayout>
 
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <vector>
+
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../image_cache.h"
+#include "../image_view.h"
+#include "../memory_accounting.h"
+#include "../point_op_pipeline.h"
+#include "../trace.h"
+
 namespace
 {
-cv::Mat applyGamma(const cv::Mat &gray, double gamma)
-{
-    cv::Mat lut(1, 256, CV_8U);
-    for (int i = 0; i < 256; ++i)
-    {
-        const double normalized = static_cast<double>(i) / 255.0;
-        const double corrected = std::pow(normalized, gamma) * 255.0;
-        lut.at<uchar>(i) = cv::saturate_cast<uchar>(corrected);
-    }
+constexpr int kGammaSteps = 50;   // 滑条 1~50 对应 gamma 0.1~5.0
+constexpr int kPrefetchRadius = 3; // 预先渲染当前位置两侧各 3 档
+constexpr int kRefineDelayMs = 80; // 停止拖动后再补算全分辨率
 
-    cv::Mat output;
-    cv::LUT(gray, lut, output);
-    return output;
+// 50 档 gamma 的查找表只在第一次使用时计算一次
+const std::array<cv::Mat, kGammaSteps> &gammaLutBank()
+{
+    static const std::array<cv::Mat, kGammaSteps> bank = [] {
+        std::array<cv::Mat, kGammaSteps> tables;
+        for (int i = 0; i < kGammaSteps; ++i)
+        {
+            PointOpPipeline ops;
+            ops.gamma(static_cast<double>(i + 1) / 10.0);
+            tables[static_cast<size_t>(i)] = cv::Mat(1, 256, CV_8U, const_cast<uchar *>(ops.table().data())).clone();
+        }
+        return tables;
+    }();
+    return bank;
 }
 } // namespace
 
+// 后台任务与界面共享：任务只写这里，不碰控件，控件销毁后任务照常结束
+struct PointGrayTransformLessonWidget::PreviewCache
+{
+    cv::Mat displayGray;
+    std::mutex mutex;
+    std::array<cv::Mat, kGammaSteps> frames;
+    std::array<bool, kGammaSteps> pending{};
+};
+
 PointGrayTransformLessonWidget::PointGrayTransformLessonWidget(QWidget *parent)
     : QWidget(parent)
 {
@@ -51,10 +78,22 @@ PointGrayTransformLessonWidget::PointGrayTransformLessonWidget(QWidget *parent)
     gammaValueLabel = new QLabel(QStringLiteral("0.60"), this);
     gammaValueLabel->setFixedWidth(40);
 
+    refineTimer = new QTimer(this);
+    refineTimer->setSingleShot(true);
+    refineTimer->setInterval(kRefineDelayMs);
+
     sliderLayout->addWidget(sliderLabel);
     sliderLayout->addWidget(gammaSlider, 1);
     sliderLayout->addWidget(gammaValueLabel);
 
+    auto *viewLayout = new QHBoxLayout();
+    originalView = new ImageView(this);
+    originalView->setCaption(QStringLiteral("Original"));
+    processedView = new ImageView(this);
+    processedView->setCaption(QStringLiteral("Gamma Result"));
+    viewLayout->addWidget(originalView, 1);
+    viewLayout->addWidget(processedView, 1);
+
     statusLabel = new QLabel(this);
     statusLabel->setStyleSheet(QStringLiteral("color: #555;"));
 
@@ -62,43 +101,82 @@ PointGrayTransformLessonWidget::PointGrayTransformLessonWidget(QWidget *parent)
     layout->addLayout(buttonLayout);
     layout->addLayout(sliderLayout);
     layout->addWidget(statusLabel);
+    layout->addLayout(viewLayout, 1);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
+    imageLoader->setPrecompute({ImageCache::Derived::Gray});
 
     connect(openButton, &QPushButton::clicked, this, &PointGrayTransformLessonWidget::openAndShow);
     connect(gammaSlider, &QSlider::valueChanged, this, &PointGrayTransformLessonWidget::updateGamma);
+    connect(refineTimer, &QTimer::timeout, this, &PointGrayTransformLessonWidget::renderFullResolution);
+}
+
+void PointGrayTransformLessonWidget::activate()
+{
+    if (refinePending)
+    {
+        refineTimer->start();
+        refinePending = false;
+    }
+}
+
+void PointGrayTransformLessonWidget::deactivate()
+{
+    // 隐藏时补算全分辨率只是白费 CPU，回来后再算
+    refinePending = refineTimer->isActive();
+    refineTimer->stop();
+}
+
+void PointGrayTransformLessonWidget::suspend()
+{
+    // 原图由 ImageCache 共享，放掉引用即可；结果缓冲区和各 gamma 的预计算帧是本课私有的
+    originalView->suspend();
+    processedView->suspend();
+    originalImage.release();
+    grayImage.release();
+    correctedImages[0].release();
+    correctedImages[1].release();
+    previews.reset();
+    refinePending = false;
+}
+
+void PointGrayTransformLessonWidget::resume()
+{
+    if (!originalView->isSuspended())
+    {
+        return;
+    }
+    // 先用预览恢复画面，再按滑动条当前的 gamma 重新读取并计算
+    originalView->resume();
+    processedView->resume();
+    openAndShow();
 }
 
 void PointGrayTransformLessonWidget::openAndShow()
 {
     const QString imagePath = QStringLiteral("cat.jpg");
-    originalImage = cv::imread(imagePath.toStdString(), cv::IMREAD_COLOR);
+    imageLoader->load(imagePath, cv::IMREAD_COLOR, [this, imagePath](const LoadedImage &loaded) {
+        showImage(imagePath, loaded.image, loaded.fullSize);
+    });
+}
+
+void PointGrayTransformLessonWidget::showImage(const QString &imagePath, const cv::Mat &image, const cv::Size &fullSize)
+{
+    originalImage = image;
     if (originalImage.empty())
     {
         statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
         return;
     }
 
-    cv::cvtColor(originalImage, grayImage, cv::COLOR_BGR2GRAY);
+    grayImage = ImageCache::instance().derived(originalImage, ImageCache::Derived::Gray);
+    fullImageSize = fullSize;
+    preparePreviews();
 
-    originalWindowName = "Original";
-    processedWindowName = "Gamma Result";
-    cv::namedWindow(originalWindowName, cv::WINDOW_NORMAL);
-    cv::namedWindow(processedWindowName, cv::WINDOW_NORMAL);
-    cv::resizeWindow(originalWindowName, 432, 648);
-    cv::resizeWindow(processedWindowName, 432, 648);
-    cv::imshow(originalWindowName, originalImage);
+    originalView->setImage(originalImage, fullSize);
 
     updateGamma(gammaSlider->value());
-
-    if (!waitKeyTimer->isActive())
-    {
-        waitKeyTimer->start();
-    }
 }
 
 void PointGrayTransformLessonWidget::updateGamma(int sliderValue)
@@ -111,8 +189,25 @@ void PointGrayTransformLessonWidget::updateGamma(int sliderValue)
     const double gamma = static_cast<double>(sliderValue) / 10.0;
     gammaValueLabel->setText(QString::number(gamma, 'f', 2));
 
-    const cv::Mat corrected = applyGamma(grayImage, gamma);
-    cv::imshow(processedWindowName, corrected);
+    const int index = sliderValue - 1;
+    cv::Mat preview;
+    if (previews)
+    {
+        std::lock_guard<std::mutex> lock(previews->mutex);
+        preview = previews->frames[static_cast<size_t>(index)];
+    }
+
+    if (preview.empty())
+    {
+        renderFullResolution();
+    }
+    else
+    {
+        // 先显示预计算好的显示分辨率结果，停下来后再补算全分辨率
+        processedView->setImage(preview, fullImageSize);
+        refineTimer->start();
+    }
+    prefetchNeighbours(index);
 
     QString effect;
     if (gamma < 1.0)
@@ -130,3 +225,82 @@ void PointGrayTransformLessonWidget::updateGamma(int sliderValue)
 
     statusLabel->setText(QStringLiteral("gamma = %1 → %2").arg(gamma, 0, 'f', 2).arg(effect));
 }
+
+void PointGrayTransformLessonWidget::renderFullResolution()
+{
+    refineTimer->stop();
+    if (grayImage.empty())
+    {
+        return;
+    }
+
+    const cv::Mat &lut = gammaLutBank()[static_cast<size_t>(gammaSlider->value() - 1)];
+    // 双缓冲：ImageView 共享着上一次传入的那块，不能原地改写，交替写另一块。
+    // 另一块仍被引用时（例如视图的后台缩小还没结束）放掉它改用新缓冲区；尺寸不变时 cv::LUT 直接写回，不再每次分配
+    cv::Mat &target = correctedImages[nextCorrected];
+    nextCorrected ^= 1;
+    if (target.u && target.u->refcount > 1)
+    {
+        target.release();
+    }
+    {
+        TRACE_SCOPE("LUT");
+        cv::LUT(grayImage, lut, target);
+    }
+    processedView->setImage(target, fullImageSize);
+}
+
+void PointGrayTransformLessonWidget::preparePreviews()
+{
+    previews.reset();
+
+    const double viewScale = processedView->devicePixelRatioF();
+    const double scale = std::min(processedView->width() * viewScale / grayImage.cols,
+                                  processedView->height() * viewScale / grayImage.rows);
+    // 图像本来就不比视图大多少时，全分辨率查表已经足够快
+    if (scale >= 0.5)
+    {
+        return;
+    }
+
+    previews = std::make_shared<PreviewCache>();
+    cv::resize(grayImage, previews->displayGray, cv::Size(), scale, scale, cv::INTER_AREA);
+}
+
+void PointGrayTransformLessonWidget::prefetchNeighbours(int index)
+{
+    if (!previews)
+    {
+        return;
+    }
+
+    const std::shared_ptr<PreviewCache> cache = previews;
+    for (int offset = -kPrefetchRadius; offset <= kPrefetchRadius; ++offset)
+    {
+        const int neighbour = index + offset;
+        if (neighbour < 0 || neighbour >= kGammaSteps)
+        {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            const auto slot = static_cast<size_t>(neighbour);
+            if (!cache->frames[slot].empty() || cache->pending[slot])
+            {
+                continue;
+            }
+            cache->pending[slot] = true;
+        }
+
+        const int lesson = memory_accounting::currentLesson();
+        QThreadPool::globalInstance()->start([cache, neighbour, lesson]() {
+            TRACE_SCOPE("LUT prefetch");
+            memory_accounting::Scope tag(lesson, "gamma previews");
+            cv::Mat frame;
+            cv::LUT(cache->displayGray, gammaLutBank()[static_cast<size_t>(neighbour)], frame);
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            cache->frames[static_cast<size_t>(neighbour)] = frame;
+            cache->pending[static_cast<size_t>(neighbour)] = false;
+        });
+    }
+}
@@ -4,28 +4,50 @@
 
 #include <opencv2/core.hpp>
 
-#include <string>
+#include <memory>
 
+#include "../lesson_lifecycle.h"
+
+class AsyncImageLoader;
+class ImageView;
 class QLabel;
 class QSlider;
 class QTimer;
 
-class PointGrayTransformLessonWidget : public QWidget
+class PointGrayTransformLessonWidget : public QWidget, public LessonLifecycle
 {
 public:
     explicit PointGrayTransformLessonWidget(QWidget *parent = nullptr);
 
+    void activate() override;
+    void deactivate() override;
+    void suspend() override;
+    void resume() override;
+
 private:
+    struct PreviewCache;
+
     QLabel *titleLabel = nullptr;
     QLabel *statusLabel = nullptr;
     QLabel *gammaValueLabel = nullptr;
     QSlider *gammaSlider = nullptr;
-    QTimer *waitKeyTimer = nullptr;
+    QTimer *refineTimer = nullptr;
+    AsyncImageLoader *imageLoader = nullptr;
     cv::Mat originalImage;
     cv::Mat grayImage;
-    std::string originalWindowName;
-    std::string processedWindowName;
+    cv::Mat correctedImages[2]; // 全分辨率结果的双缓冲，拖动过程中交替复用
+    int nextCorrected = 0;
+    cv::Size fullImageSize;
+    ImageView *originalView = nullptr;
+    ImageView *processedView = nullptr;
+    // 显示分辨率的预计算结果，后台线程填充；图像不比视图大时为空
+    std::shared_ptr<PreviewCache> previews;
+    bool refinePending = false; // 离开页面时还有待补算的全分辨率结果
 
     void openAndShow();
+    void showImage(const QString &imagePath, const cv::Mat &image, const cv::Size &fullSize);
     void updateGamma(int sliderValue);
+    void renderFullResolution();
+    void preparePreviews();
+    void prefetchNeighbours(int index);
 };
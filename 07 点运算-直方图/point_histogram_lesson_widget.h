@@ -4,22 +4,27 @@
 
 #include <opencv2/core.hpp>
 
-#include <string>
+#include "../lesson_lifecycle.h"
 
+class AsyncImageLoader;
+class ImageView;
 class QLabel;
-class QTimer;
 
-class PointHistogramLessonWidget : public QWidget
+class PointHistogramLessonWidget : public QWidget, public LessonLifecycle
 {
 public:
     explicit PointHistogramLessonWidget(QWidget *parent = nullptr);
 
+    void suspend() override;
+    void resume() override;
+
 private:
     QLabel *titleLabel = nullptr;
     QLabel *statusLabel = nullptr;
-    QTimer *waitKeyTimer = nullptr;
-    std::string originalWindowName;
-    std::string processedWindowName;
+    AsyncImageLoader *imageLoader = nullptr;
+    ImageView *originalView = nullptr;
+    ImageView *processedView = nullptr;
 
     void openAndShow();
+    void showImage(const QString &imagePath, const cv::Mat &color, const cv::Size &fullSize);
 };
@@ -3,11 +3,15 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QTimer>
 #include <QVBoxLayout>
 
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../image_cache.h"
+#include "../image_view.h"
+#include "../point_op_pipeline.h"
+
 PointTruncationLessonWidget::PointTruncationLessonWidget(QWidget *parent)
     : QWidget(parent)
 {
@@ -22,51 +26,72 @@ PointTruncationLessonWidget::PointTruncationLessonWidget(QWidget *parent)
     buttonLayout->addWidget(openButton);
     buttonLayout->addStretch();
 
+    auto *viewLayout = new QHBoxLayout();
+    originalView = new ImageView(this);
+    originalView->setCaption(QStringLiteral("Original (Gray)"));
+    processedView = new ImageView(this);
+    processedView->setCaption(QStringLiteral("Truncated"));
+    viewLayout->addWidget(originalView, 1);
+    viewLayout->addWidget(processedView, 1);
+
     statusLabel = new QLabel(this);
     statusLabel->setStyleSheet(QStringLiteral("color: #555;"));
 
     layout->addWidget(titleLabel);
     layout->addLayout(buttonLayout);
     layout->addWidget(statusLabel);
+    layout->addLayout(viewLayout, 1);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
+    imageLoader->setPrecompute({ImageCache::Derived::Gray});
 
     connect(openButton, &QPushButton::clicked, this, &PointTruncationLessonWidget::openAndShow);
 }
 
+void PointTruncationLessonWidget::suspend()
+{
+    // 两个视图各留一张编码后的显示尺寸预览，金字塔和瓦片随之释放
+    originalView->suspend();
+    processedView->suspend();
+}
+
+void PointTruncationLessonWidget::resume()
+{
+    if (!originalView->isSuspended())
+    {
+        return;
+    }
+    // 先用预览恢复画面，再重新读取（通常命中 ImageCache）算出全分辨率结果
+    originalView->resume();
+    processedView->resume();
+    openAndShow();
+}
+
 void PointTruncationLessonWidget::openAndShow()
 {
     const QString imagePath = QStringLiteral("cat.jpg");
-    const cv::Mat color = cv::imread(imagePath.toStdString(), cv::IMREAD_COLOR);
+    imageLoader->load(imagePath, cv::IMREAD_COLOR, [this, imagePath](const LoadedImage &loaded) {
+        showImage(imagePath, loaded.image, loaded.fullSize);
+    });
+}
+
+void PointTruncationLessonWidget::showImage(const QString &imagePath, const cv::Mat &color, const cv::Size &fullSize)
+{
     if (color.empty())
     {
         statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
         return;
     }
 
-    cv::Mat gray;
-    cv::cvtColor(color, gray, cv::COLOR_BGR2GRAY);
+    const cv::Mat gray = ImageCache::instance().derived(color, ImageCache::Derived::Gray);
 
     const double thresholdValue = 120.0;
     cv::Mat truncated;
-    cv::threshold(gray, truncated, thresholdValue, 255.0, cv::THRESH_TRUNC);
+    PointOpPipeline().truncate(thresholdValue).apply(gray, truncated);
 
-    originalWindowName = "Original (Gray)";
-    processedWindowName = "Truncated";
-    cv::namedWindow(originalWindowName, cv::WINDOW_NORMAL);
-    cv::namedWindow(processedWindowName, cv::WINDOW_NORMAL);
-    cv::resizeWindow(originalWindowName, 432, 648);
-    cv::resizeWindow(processedWindowName, 432, 648);
-    cv::imshow(originalWindowName, gray);
-    cv::imshow(processedWindowName, truncated);
+    originalView->setImage(gray, fullSize);
+    processedView->setImage(truncated, fullSize);
 
     statusLabel->setText(QStringLiteral("阈值截断：threshold=%1").arg(thresholdValue, 0, 'f', 0));
-    if (!waitKeyTimer->isActive())
-    {
-        waitKeyTimer->start();
-    }
 }
@@ -3,11 +3,24 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QTimer>
+#include <QSlider>
 #include <QVBoxLayout>
 
+#include <algorithm>
+
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../color_adjust.h"
+#include "../image_view.h"
+#include "../processing_worker.h"
+
+namespace
+{
+// 每处理这么多行检查一次是否已被更新的参数取代
+constexpr int kBandRows = 128;
+} // namespace
+
 PointColorAdjustLessonWidget::PointColorAdjustLessonWidget(QWidget *parent)
     : QWidget(parent)
 {
@@ -22,61 +35,168 @@ PointColorAdjustLessonWidget::PointColorAdjustLessonWidget(QWidget *parent)
     buttonLayout->addWidget(openButton);
     buttonLayout->addStretch();
 
+    auto *sliderLayout = new QVBoxLayout();
+    saturationSlider = addSlider(sliderLayout, QStringLiteral("饱和度 S +"), -100, 100, 40);
+    hueSlider = addSlider(sliderLayout, QStringLiteral("色相偏移°"), -180, 180, 0);
+    redGainSlider = addSlider(sliderLayout, QStringLiteral("红色增益 %"), 0, 200, 120);
+    greenGainSlider = addSlider(sliderLayout, QStringLiteral("绿色增益 %"), 0, 200, 100);
+    blueGainSlider = addSlider(sliderLayout, QStringLiteral("蓝色增益 %"), 0, 200, 80);
+
+    auto *viewLayout = new QHBoxLayout();
+    originalView = new ImageView(this);
+    originalView->setCaption(QStringLiteral("Original"));
+    processedView = new ImageView(this);
+    processedView->setCaption(QStringLiteral("Saturation & Color"));
+    viewLayout->addWidget(originalView, 1);
+    viewLayout->addWidget(processedView, 1);
+
     statusLabel = new QLabel(this);
     statusLabel->setStyleSheet(QStringLiteral("color: #555;"));
 
     layout->addWidget(titleLabel);
     layout->addLayout(buttonLayout);
+    layout->addLayout(sliderLayout);
     layout->addWidget(statusLabel);
+    layout->addLayout(viewLayout, 1);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
+    processingWorker = new ProcessingWorker(this);
 
     connect(openButton, &QPushButton::clicked, this, &PointColorAdjustLessonWidget::openAndShow);
+    for (QSlider *slider : {saturationSlider, hueSlider, redGainSlider, greenGainSlider, blueGainSlider})
+    {
+        connect(slider, &QSlider::valueChanged, this, &PointColorAdjustLessonWidget::updateAdjustment);
+    }
+}
+
+QSlider *PointColorAdjustLessonWidget::addSlider(QVBoxLayout *layout,
+                                                 const QString &title,
+                                                 int minimum,
+                                                 int maximum,
+                                                 int value)
+{
+    auto *row = new QHBoxLayout();
+    auto *titleText = new QLabel(title, this);
+    titleText->setFixedWidth(90);
+    auto *slider = new QSlider(Qt::Horizontal, this);
+    slider->setRange(minimum, maximum);
+    slider->setValue(value);
+    auto *valueLabel = new QLabel(QString::number(value), this);
+    valueLabel->setFixedWidth(40);
+    connect(slider, &QSlider::valueChanged, valueLabel, [valueLabel](int v) { valueLabel->setText(QString::number(v)); });
+
+    row->addWidget(titleText);
+    row->addWidget(slider, 1);
+    row->addWidget(valueLabel);
+    layout->addLayout(row);
+    return slider;
+}
+
+void PointColorAdjustLessonWidget::activate()
+{
+    if (adjustmentPending)
+    {
+        adjustmentPending = false;
+        updateAdjustment();
+    }
+}
+
+void PointColorAdjustLessonWidget::deactivate()
+{
+    // 取消还没显示的调整，回来后按滑动条当前值重新提交
+    const ProcessingWorker::Stats stats = processingWorker->stats();
+    adjustmentPending = stats.submitted > stats.completed + stats.dropped + stats.cancelled;
+    processingWorker->cancel();
+}
+
+void PointColorAdjustLessonWidget::suspend()
+{
+    originalView->suspend();
+    processedView->suspend();
+    colorImage.release();
+    adjustmentPending = false;
+}
+
+void PointColorAdjustLessonWidget::resume()
+{
+    if (!originalView->isSuspended())
+    {
+        return;
+    }
+    // 先用预览恢复画面，再重新读取并按滑动条当前值重新调整
+    originalView->resume();
+    processedView->resume();
+    openAndShow();
 }
 
 void PointColorAdjustLessonWidget::openAndShow()
 {
     const QString imagePath = QStringLiteral("cat.jpg");
-    const cv::Mat color = cv::imread(imagePath.toStdString(), cv::IMREAD_COLOR);
+    imageLoader->load(imagePath, cv::IMREAD_COLOR, [this, imagePath](const LoadedImage &loaded) {
+        showImage(imagePath, loaded.image, loaded.fullSize);
+    });
+}
+
+void PointColorAdjustLessonWidget::showImage(const QString &imagePath, const cv::Mat &color, const cv::Size &fullSize)
+{
     if (color.empty())
     {
         statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
         return;
     }
 
-    cv::Mat hsv;
-    cv::cvtColor(color, hsv, cv::COLOR_BGR2HSV);
-
-    std::vector<cv::Mat> hsvChannels;
-    cv::split(hsv, hsvChannels);
-    cv::add(hsvChannels[1], cv::Scalar(40), hsvChannels[1]);
-    cv::merge(hsvChannels, hsv);
-
-    cv::Mat saturated;
-    cv::cvtColor(hsv, saturated, cv::COLOR_HSV2BGR);
-
-    std::vector<cv::Mat> bgrChannels;
-    cv::split(saturated, bgrChannels);
-    bgrChannels[2].convertTo(bgrChannels[2], -1, 1.2, 0.0);
-    bgrChannels[0].convertTo(bgrChannels[0], -1, 0.8, 0.0);
-    cv::merge(bgrChannels, saturated);
-
-    originalWindowName = "Original";
-    processedWindowName = "Saturation & Color";
-    cv::namedWindow(originalWindowName, cv::WINDOW_NORMAL);
-    cv::namedWindow(processedWindowName, cv::WINDOW_NORMAL);
-    cv::resizeWindow(originalWindowName, 432, 648);
-    cv::resizeWindow(processedWindowName, 432, 648);
-    cv::imshow(originalWindowName, color);
-    cv::imshow(processedWindowName, saturated);
-
-    statusLabel->setText(QStringLiteral("S 通道 +40，红色增强 1.2 倍，蓝色抑制 0.8 倍"));
-    if (!waitKeyTimer->isActive())
+    colorImage = color;
+    fullImageSize = fullSize;
+    originalView->setImage(colorImage, fullImageSize);
+    updateAdjustment();
+}
+
+void PointColorAdjustLessonWidget::updateAdjustment()
+{
+    if (colorImage.empty())
     {
-        waitKeyTimer->start();
+        return;
     }
+
+    ColorAdjustParams params;
+    params.saturationOffset = saturationSlider->value();
+    params.hueShift = hueSlider->value();
+    params.redGain = redGainSlider->value() / 100.0;
+    params.greenGain = greenGainSlider->value() / 100.0;
+    params.blueGain = blueGainSlider->value() / 100.0;
+
+    // 在处理线程里重建 33³ 个格点并分行带查表；拖动时尚未开始的旧参数直接被新值替换
+    const cv::Mat source = colorImage;
+    const cv::Size logicalSize = fullImageSize;
+    processingWorker->submit([this, params, source, logicalSize](const CancelToken &token) -> ProcessingWorker::Present {
+        const ColorAdjustLut lut(params);
+        cv::Mat adjusted(source.size(), CV_8UC3);
+        for (int y = 0; y < source.rows; y += kBandRows)
+        {
+            if (token.isCancelled())
+            {
+                return nullptr;
+            }
+            const cv::Range rows(y, std::min(y + kBandRows, source.rows));
+            cv::Mat band = adjusted.rowRange(rows);
+            lut.apply(source.rowRange(rows), band);
+        }
+
+        return [this, params, adjusted, logicalSize]() {
+            processedView->setImage(adjusted, logicalSize);
+
+            const ProcessingWorker::Stats stats = processingWorker->stats();
+            statusLabel->setText(QStringLiteral("S %1，色相 %2°，增益 R×%3 G×%4 B×%5（33³ 3D LUT 单遍插值）\n"
+                                                "处理任务：完成 %6，丢弃 %7，取消 %8")
+                                     .arg(params.saturationOffset, 0, 'f', 0)
+                                     .arg(params.hueShift, 0, 'f', 0)
+                                     .arg(params.redGain, 0, 'f', 2)
+                                     .arg(params.greenGain, 0, 'f', 2)
+                                     .arg(params.blueGain, 0, 'f', 2)
+                                     .arg(stats.completed)
+                                     .arg(stats.dropped)
+                                     .arg(stats.cancelled));
+        };
+    });
 }
@@ -2,22 +2,45 @@
 
 #include <QWidget>
 
-#include <string>
+#include <opencv2/core.hpp>
 
+#include "../lesson_lifecycle.h"
+
+class AsyncImageLoader;
+class ImageView;
+class ProcessingWorker;
 class QLabel;
-class QTimer;
+class QSlider;
+class QVBoxLayout;
 
-class PointColorAdjustLessonWidget : public QWidget
+class PointColorAdjustLessonWidget : public QWidget, public LessonLifecycle
 {
 public:
     explicit PointColorAdjustLessonWidget(QWidget *parent = nullptr);
 
+    void activate() override;
+    void deactivate() override;
+    void suspend() override;
+    void resume() override;
+
 private:
     QLabel *titleLabel = nullptr;
     QLabel *statusLabel = nullptr;
-    QTimer *waitKeyTimer = nullptr;
-    std::string originalWindowName;
-    std::string processedWindowName;
+    QSlider *saturationSlider = nullptr;
+    QSlider *hueSlider = nullptr;
+    QSlider *redGainSlider = nullptr;
+    QSlider *greenGainSlider = nullptr;
+    QSlider *blueGainSlider = nullptr;
+    AsyncImageLoader *imageLoader = nullptr;
+    ImageView *originalView = nullptr;
+    ImageView *processedView = nullptr;
+    ProcessingWorker *processingWorker = nullptr;
+    cv::Mat colorImage;
+    cv::Size fullImageSize;
+    bool adjustmentPending = false; // 离开页面时有未完成的调整被取消
 
+    QSlider *addSlider(QVBoxLayout *layout, const QString &title, int minimum, int maximum, int value);
     void openAndShow();
+    void showImage(const QString &imagePath, const cv::Mat &color, const cv::Size &fullSize);
+    void updateAdjustment();
 };
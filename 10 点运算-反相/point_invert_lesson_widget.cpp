@@ -3,11 +3,14 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QTimer>
 #include <QVBoxLayout>
 
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../image_view.h"
+#include "../point_op_pipeline.h"
+
 PointInvertLessonWidget::PointInvertLessonWidget(QWidget *parent)
     : QWidget(parent)
 {
@@ -22,26 +25,57 @@ PointInvertLessonWidget::PointInvertLessonWidget(QWidget *parent)
     buttonLayout->addWidget(openButton);
     buttonLayout->addStretch();
 
+    auto *viewLayout = new QHBoxLayout();
+    originalView = new ImageView(this);
+    originalView->setCaption(QStringLiteral("Original"));
+    processedView = new ImageView(this);
+    processedView->setCaption(QStringLiteral("Inverted"));
+    viewLayout->addWidget(originalView, 1);
+    viewLayout->addWidget(processedView, 1);
+
     statusLabel = new QLabel(this);
     statusLabel->setStyleSheet(QStringLiteral("color: #555;"));
 
     layout->addWidget(titleLabel);
     layout->addLayout(buttonLayout);
     layout->addWidget(statusLabel);
+    layout->addLayout(viewLayout, 1);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
 
     connect(openButton, &QPushButton::clicked, this, &PointInvertLessonWidget::openAndShow);
 }
 
+void PointInvertLessonWidget::suspend()
+{
+    // 两个视图各留一张编码后的显示尺寸预览，金字塔和瓦片随之释放
+    originalView->suspend();
+    processedView->suspend();
+}
+
+void PointInvertLessonWidget::resume()
+{
+    if (!originalView->isSuspended())
+    {
+        return;
+    }
+    // 先用预览恢复画面，再重新读取（通常命中 ImageCache）算出全分辨率结果
+    originalView->resume();
+    processedView->resume();
+    openAndShow();
+}
+
 void PointInvertLessonWidget::openAndShow()
 {
     const QString imagePath = QStringLiteral("cat.jpg");
-    const cv::Mat color = cv::imread(imagePath.toStdString(), cv::IMREAD_COLOR);
+    imageLoader->load(imagePath, cv::IMREAD_COLOR, [this, imagePath](const LoadedImage &loaded) {
+        showImage(imagePath, loaded.image, loaded.fullSize);
+    });
+}
+
+void PointInvertLessonWidget::showImage(const QString &imagePath, const cv::Mat &color, const cv::Size &fullSize)
+{
     if (color.empty())
     {
         statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
@@ -49,20 +83,10 @@ void PointInvertLessonWidget::openAndShow()
     }
 
     cv::Mat inverted;
-    cv::bitwise_not(color, inverted);
+    PointOpPipeline().invert().apply(color, inverted);
 
-    originalWindowName = "Original";
-    processedWindowName = "Inverted";
-    cv::namedWindow(originalWindowName, cv::WINDOW_NORMAL);
-    cv::namedWindow(processedWindowName, cv::WINDOW_NORMAL);
-    cv::resizeWindow(originalWindowName, 432, 648);
-    cv::resizeWindow(processedWindowName, 432, 648);
-    cv::imshow(originalWindowName, color);
-    cv::imshow(processedWindowName, inverted);
+    originalView->setImage(color, fullSize);
+    processedView->setImage(inverted, fullSize);
 
     statusLabel->setText(QStringLiteral("逐像素反相：I' = 255 - I"));
-    if (!waitKeyTimer->isActive())
-    {
-        waitKeyTimer->start();
-    }
 }
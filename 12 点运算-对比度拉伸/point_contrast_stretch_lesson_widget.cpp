@@ -3,11 +3,16 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QTimer>
 #include <QVBoxLayout>
 
 #include <opencv2/opencv.hpp>
 
+#include "../async_image_loader.h"
+#include "../image_cache.h"
+#include "../image_view.h"
+#include "../point_op_pipeline.h"
+#include "../trace.h"
+
 PointContrastStretchLessonWidget::PointContrastStretchLessonWidget(QWidget *parent)
     : QWidget(parent)
 {
@@ -22,61 +27,80 @@ PointContrastStretchLessonWidget::PointContrastStretchLessonWidget(QWidget *pare
     buttonLayout->addWidget(openButton);
     buttonLayout->addStretch();
 
+    auto *viewLayout = new QHBoxLayout();
+    originalView = new ImageView(this);
+    originalView->setCaption(QStringLiteral("Original (Gray)"));
+    processedView = new ImageView(this);
+    processedView->setCaption(QStringLiteral("Contrast Stretched"));
+    viewLayout->addWidget(originalView, 1);
+    viewLayout->addWidget(processedView, 1);
+
     statusLabel = new QLabel(this);
     statusLabel->setStyleSheet(QStringLiteral("color: #555;"));
 
     layout->addWidget(titleLabel);
     layout->addLayout(buttonLayout);
     layout->addWidget(statusLabel);
+    layout->addLayout(viewLayout, 1);
 
-    waitKeyTimer = new QTimer(this);
-    waitKeyTimer->setInterval(30);
-    connect(waitKeyTimer, &QTimer::timeout, this, []() {
-        cv::waitKey(1);
-    });
+    imageLoader = new AsyncImageLoader(this);
+    imageLoader->setProgressLabel(statusLabel);
+    imageLoader->setPrecompute({ImageCache::Derived::Gray});
 
     connect(openButton, &QPushButton::clicked, this, &PointContrastStretchLessonWidget::openAndShow);
 }
 
+void PointContrastStretchLessonWidget::suspend()
+{
+    // 两个视图各留一张编码后的显示尺寸预览，金字塔和瓦片随之释放
+    originalView->suspend();
+    processedView->suspend();
+}
+
+void PointContrastStretchLessonWidget::resume()
+{
+    if (!originalView->isSuspended())
+    {
+        return;
+    }
+    // 先用预览恢复画面，再重新读取（通常命中 ImageCache）算出全分辨率结果
+    originalView->resume();
+    processedView->resume();
+    openAndShow();
+}
+
 void PointContrastStretchLessonWidget::openAndShow()
 {
     const QString imagePath = QStringLiteral("cat.jpg");
-    const cv::Mat color = cv::imread(imagePath.toStdString(), cv::IMREAD_COLOR);
+    imageLoader->load(imagePath, cv::IMREAD_COLOR, [this, imagePath](const LoadedImage &loaded) {
+        showImage(imagePath, loaded.image, loaded.fullSize);
+    });
+}
+
+void PointContrastStretchLessonWidget::showImage(const QString &imagePath, const cv::Mat &color, const cv::Size &fullSize)
+{
     if (color.empty())
     {
         statusLabel->setText(QStringLiteral("读取失败：%1（请确认在当前目录）").arg(imagePath));
         return;
     }
 
-    cv::Mat gray;
-    cv::cvtColor(color, gray, cv::COLOR_BGR2GRAY);
+    const cv::Mat gray = ImageCache::instance().derived(color, ImageCache::Derived::Gray);
 
     double minValue = 0.0;
     double maxValue = 0.0;
-    cv::minMaxLoc(gray, &minValue, &maxValue);
-
-    cv::Mat stretched = gray.clone();
-    if (maxValue > minValue)
     {
-        const double alpha = 255.0 / (maxValue - minValue);
-        const double beta = -minValue * alpha;
-        gray.convertTo(stretched, CV_8U, alpha, beta);
+        TRACE_SCOPE("minMaxLoc");
+        cv::minMaxLoc(gray, &minValue, &maxValue);
     }
 
-    originalWindowName = "Original (Gray)";
-    processedWindowName = "Contrast Stretched";
-    cv::namedWindow(originalWindowName, cv::WINDOW_NORMAL);
-    cv::namedWindow(processedWindowName, cv::WINDOW_NORMAL);
-    cv::resizeWindow(originalWindowName, 432, 648);
-    cv::resizeWindow(processedWindowName, 432, 648);
-    cv::imshow(originalWindowName, gray);
-    cv::imshow(processedWindowName, stretched);
+    cv::Mat stretched;
+    PointOpPipeline().stretch(minValue, maxValue).apply(gray, stretched);
+
+    originalView->setImage(gray, fullSize);
+    processedView->setImage(stretched, fullSize);
 
     statusLabel->setText(QStringLiteral("对比度拉伸：min=%1 max=%2")
                              .arg(minValue, 0, 'f', 1)
                              .arg(maxValue, 0, 'f', 1));
-    if (!waitKeyTimer->isActive())
-    {
-        waitKeyTimer->start();
-    }
 }
@@ -0,0 +1,278 @@
+#include "async_image_loader.h"
+
+#include <QEvent>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QLabel>
+#include <QMetaObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <QWidget>
+
+#include <algorithm>
+#include <utility>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "image_cache.h"
+#include "trace.h"
+
+namespace
+{
+// 课程里的 HighGUI 窗口固定为 432x648，预览只要长边不小于这个尺寸就足够清晰
+constexpr int kPreviewLongEdge = 648;
+
+// 只读文件头获取尺寸，不解码像素
+cv::Size probeImageSize(const QString &path)
+{
+    QImageReader reader(path);
+    const QSize size = reader.size();
+    return size.isValid() ? cv::Size(size.width(), size.height()) : cv::Size();
+}
+
+// 返回预览用的 reduced 标志，不适合预览时返回 -1
+int previewFlags(const QString &path, int flags, const cv::Size &fullSize)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix != QStringLiteral("jpg") && suffix != QStringLiteral("jpeg"))
+    {
+        return -1;
+    }
+    if (flags != cv::IMREAD_COLOR && flags != cv::IMREAD_GRAYSCALE)
+    {
+        return -1;
+    }
+
+    // 选最大的缩小倍数，同时保证预览长边仍不小于显示尺寸
+    const int longEdge = std::max(fullSize.width, fullSize.height);
+    int factor = 1;
+    for (int candidate : {8, 4, 2})
+    {
+        if (longEdge / candidate >= kPreviewLongEdge)
+        {
+            factor = candidate;
+            break;
+        }
+    }
+
+    const bool color = flags == cv::IMREAD_COLOR;
+    switch (factor)
+    {
+    case 2:
+        return color ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2;
+    case 4:
+        return color ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4;
+    case 8:
+        return color ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8;
+    default:
+        return -1;
+    }
+}
+} // namespace
+
+AsyncImageLoader::AsyncImageLoader(QWidget *owner)
+    : QObject(owner)
+{
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(100);
+    connect(progressTimer, &QTimer::timeout, this, [this]() {
+        updateProgress();
+    });
+
+    if (owner)
+    {
+        owner->installEventFilter(this);
+    }
+}
+
+AsyncImageLoader::~AsyncImageLoader()
+{
+    // 必须在 QObject 析构前完成：工作线程持锁投递结果，这里取得同一把锁后就不会再有新的投递。
+    // 析构时兄弟控件可能已被删除，因此只作废请求，不碰界面。
+    cancelRequest();
+}
+
+void AsyncImageLoader::setProgressLabel(QLabel *label)
+{
+    progressLabel = label;
+}
+
+void AsyncImageLoader::load(const QString &path, int flags, LoadedCallback onLoaded, Preview preview)
+{
+    cancelRequest();
+
+    auto request = std::make_shared<Request>();
+    currentRequest = request;
+    loadedCallback = std::move(onLoaded);
+    loadingPath = path;
+    previewStatusText.clear();
+    elapsed.start();
+    updateProgress();
+    progressTimer->start();
+
+    QThreadPool::globalInstance()->start([this, request, path, flags, preview, kinds = precompute]() {
+        const auto isCancelled = [&request]() {
+            std::lock_guard<std::mutex> lock(request->mutex);
+            return request->cancelled;
+        };
+        // 持锁投递：cancel() 需要同一把锁，所以这里的 this 一定还活着；
+        // 若投递后 loader 被销毁，Qt 会随对象一起丢弃尚未处理的事件
+        const auto post = [this, &request, &kinds](const LoadedImage &loaded) {
+            // 预览不在 ImageCache 里，derived() 不会保存它的派生表示，预先转换只是白算
+            for (const ImageCache::Derived kind : loaded.isPreview ? std::vector<ImageCache::Derived>() : kinds)
+            {
+                ImageCache::instance().derived(loaded.image, kind);
+            }
+            std::lock_guard<std::mutex> lock(request->mutex);
+            if (request->cancelled)
+            {
+                return;
+            }
+            QMetaObject::invokeMethod(this, [this, request, loaded]() {
+                deliver(request, loaded);
+            }, Qt::QueuedConnection);
+        };
+
+        if (isCancelled())
+        {
+            return;
+        }
+
+        LoadedImage loaded;
+        loaded.image = ImageCache::instance().lookup(path, flags);
+        if (loaded.image.empty() && preview == Preview::Progressive)
+        {
+            const cv::Size fullSize = probeImageSize(path);
+            const int reducedFlags = previewFlags(path, flags, fullSize);
+            if (reducedFlags >= 0)
+            {
+                // 预览只用一次，全分辨率一到就被替换：直接解码，不放进共享缓存，
+                // 否则每幅大图都会在缓存里多留一份 reduced 条目，挤占真正会复用的原图
+                LoadedImage previewImage;
+                {
+                    TRACE_SCOPE("imread preview");
+                    previewImage.image = cv::imread(path.toStdString(), reducedFlags);
+                }
+                previewImage.fullSize = fullSize;
+                previewImage.isPreview = true;
+                if (!previewImage.image.empty())
+                {
+                    post(previewImage);
+                }
+                if (isCancelled())
+                {
+                    return;
+                }
+            }
+        }
+
+        if (loaded.image.empty())
+        {
+            loaded.image = ImageCache::instance().imread(path, flags);
+        }
+        loaded.fullSize = loaded.image.size();
+        post(loaded);
+    });
+}
+
+void AsyncImageLoader::setPrecompute(std::vector<ImageCache::Derived> kinds)
+{
+    precompute = std::move(kinds);
+}
+
+void AsyncImageLoader::cancel()
+{
+    if (!cancelRequest())
+    {
+        return;
+    }
+
+    progressTimer->stop();
+    if (progressLabel)
+    {
+        progressLabel->setText(QStringLiteral("已取消读取：%1").arg(loadingPath));
+    }
+}
+
+bool AsyncImageLoader::cancelRequest()
+{
+    if (!currentRequest)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(currentRequest->mutex);
+        currentRequest->cancelled = true;
+    }
+    currentRequest.reset();
+    loadedCallback = nullptr;
+    return true;
+}
+
+bool AsyncImageLoader::isLoading() const
+{
+    return currentRequest != nullptr;
+}
+
+bool AsyncImageLoader::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == parent() && event->type() == QEvent::Hide)
+    {
+        cancel();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void AsyncImageLoader::deliver(const std::shared_ptr<Request> &request, const LoadedImage &loaded)
+{
+    // 已被更新的请求取代或已取消：丢弃结果
+    if (request != currentRequest)
+    {
+        return;
+    }
+
+    if (!loaded.isPreview)
+    {
+        currentRequest.reset();
+        progressTimer->stop();
+    }
+
+    // 拷贝一份再调用：回调里可以安全地发起新的 load()，替换掉 loadedCallback
+    const LoadedCallback callback = loadedCallback;
+    if (!loaded.isPreview)
+    {
+        loadedCallback = nullptr;
+    }
+    if (callback)
+    {
+        callback(loaded);
+    }
+
+    // 预览已显示：在课程写入的状态文字后面继续提示全分辨率的加载进度
+    if (loaded.isPreview && request == currentRequest && progressLabel)
+    {
+        previewStatusText = progressLabel->text() + QStringLiteral("\n预览 %1x%2 / 原图 %3x%4，正在加载全分辨率")
+                                                        .arg(loaded.image.cols)
+                                                        .arg(loaded.image.rows)
+                                                        .arg(loaded.fullSize.width)
+                                                        .arg(loaded.fullSize.height);
+        updateProgress();
+    }
+}
+
+void AsyncImageLoader::updateProgress()
+{
+    if (!progressLabel)
+    {
+        return;
+    }
+
+    const QString seconds = QString::number(static_cast<double>(elapsed.elapsed()) / 1000.0, 'f', 1);
+    if (!previewStatusText.isEmpty())
+    {
+        progressLabel->setText(QStringLiteral("%1（已用时 %2 s）").arg(previewStatusText, seconds));
+        return;
+    }
+    progressLabel->setText(QStringLiteral("正在后台读取：%1（已用时 %2 s）").arg(loadingPath, seconds));
+}
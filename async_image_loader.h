@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "image_cache.h"
+
+class QEvent;
+class QLabel;
+class QTimer;
+class QWidget;
+
+// 一次读取的结果。渐进式读取会先送达一张低分辨率预览（isPreview = true），
+// 随后再送达全分辨率图像；fullSize 始终是原图尺寸，方便界面按原图坐标显示预览。
+struct LoadedImage
+{
+    cv::Mat image;
+    cv::Size fullSize;
+    bool isPreview = false;
+};
+
+// 在全局线程池里解码图片（经由 ImageCache），结果通过排队调用送回 GUI 线程。
+// 每个课程控件持有一个实例，以控件为 parent：
+// - 再次 load() 或 cancel() 会作废之前的请求，只有最新请求的回调会执行；
+// - owner 被隐藏（离开页面）时自动取消；
+// - 已经开始的解码无法中断，但其结果仍会进入 ImageCache，下次读取可直接命中。
+class AsyncImageLoader : public QObject
+{
+public:
+    using LoadedCallback = std::function<void(const LoadedImage &loaded)>;
+
+    // Progressive：大尺寸 JPEG 先用 IMREAD_REDUCED_* 解码一张接近显示尺寸的预览，
+    // 立即回调一次，再在同一后台任务里解码全分辨率并再次回调。预览直接解码，不进入 ImageCache。
+    // 只对 IMREAD_COLOR / IMREAD_GRAYSCALE 生效：其余格式的 reduced 读取是“全解码后缩放”，反而更慢。
+    enum class Preview
+    {
+        None,
+        Progressive
+    };
+
+    explicit AsyncImageLoader(QWidget *owner);
+    ~AsyncImageLoader() override;
+
+    // 读取期间在 label 上显示进度（已用时间），读取完成后由回调负责更新文字
+    void setProgressLabel(QLabel *label);
+    // 解码后在同一后台任务里顺带生成这些派生表示（见 ImageCache::derived），
+    // 课程在回调里再取时直接命中，不占用界面线程
+    void setPrecompute(std::vector<ImageCache::Derived> kinds);
+
+    void load(const QString &path, int flags, LoadedCallback onLoaded, Preview preview = Preview::Progressive);
+    void cancel();
+    bool isLoading() const;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Request
+    {
+        std::mutex mutex;
+        bool cancelled = false;
+    };
+
+    bool cancelRequest();
+    void deliver(const std::shared_ptr<Request> &request, const LoadedImage &loaded);
+    void updateProgress();
+
+    QPointer<QLabel> progressLabel;
+    QTimer *progressTimer = nullptr;
+    QElapsedTimer elapsed;
+    QString loadingPath;
+    QString previewStatusText;
+    LoadedCallback loadedCallback;
+    std::vector<ImageCache::Derived> precompute;
+    std::shared_ptr<Request> currentRequest;
+};
@@ -0,0 +1,358 @@
+#include "batch_runner.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+
+namespace
+{
+// 有界阻塞队列：push 在满时阻塞，pop 在空时阻塞；close 后 pop 取完剩余元素即返回 false
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(std::max<size_t>(1, capacity)) {}
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return !items.empty() || closed; });
+        if (items.empty())
+        {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+private:
+    const size_t capacity;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<T> items;
+    bool closed = false;
+};
+
+struct BatchItem
+{
+    QString inputPath;
+    QString outputPath;
+    QByteArray fileData;
+    cv::Mat image;
+    std::vector<uchar> encoded;
+};
+
+class BatchStats
+{
+public:
+    void fail(const QString &path, const QString &reason)
+    {
+        failed.fetch_add(1);
+        std::lock_guard<std::mutex> lock(printMutex);
+        std::fprintf(stderr, "失败：%s（%s）\n", qPrintable(path), qPrintable(reason));
+    }
+
+    void succeed() { succeeded.fetch_add(1); }
+
+    std::atomic<int> succeeded{0};
+    std::atomic<int> failed{0};
+    std::atomic<qint64> pixels{0};
+
+private:
+    std::mutex printMutex;
+};
+
+// 启动一级流水线：count 个线程执行同一个 body
+template <typename Body>
+std::vector<std::thread> startStage(int count, Body body)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        threads.emplace_back(body);
+    }
+    return threads;
+}
+
+void joinAll(std::vector<std::thread> &threads)
+{
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+bool isImageFile(const QFileInfo &info)
+{
+    static const QStringList suffixes = {
+        QStringLiteral("bmp"), QStringLiteral("jpg"), QStringLiteral("jpeg"), QStringLiteral("png"),
+        QStringLiteral("tif"), QStringLiteral("tiff"), QStringLiteral("webp"), QStringLiteral("pgm"),
+        QStringLiteral("ppm"), QStringLiteral("exr"), QStringLiteral("hdr")};
+    return info.isFile() && suffixes.contains(info.suffix().toLower());
+}
+} // namespace
+
+QStringList collectBatchInputs(const QString &input)
+{
+    const QFileInfo inputInfo(input);
+    QStringList files;
+    if (inputInfo.isDir())
+    {
+        const QFileInfoList entries = QDir(input).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &entry : entries)
+        {
+            if (isImageFile(entry))
+            {
+                files.append(entry.filePath());
+            }
+        }
+        return files;
+    }
+    if (inputInfo.isFile())
+    {
+        return {input};
+    }
+
+    // 通配符只作用于文件名部分
+    const QDir dir = inputInfo.dir();
+    const QFileInfoList entries = dir.entryInfoList({inputInfo.fileName()}, QDir::Files, QDir::Name);
+    for (const QFileInfo &entry : entries)
+    {
+        files.append(entry.filePath());
+    }
+    return files;
+}
+
+int runBatch(const BatchOptions &options)
+{
+    const ImageOperation *operation = findImageOperation(options.operation);
+    if (!operation)
+    {
+        std::fprintf(stderr, "未知操作：%s\n", options.operation.c_str());
+        return 2;
+    }
+
+    const QStringList inputs = collectBatchInputs(options.input);
+    if (inputs.isEmpty())
+    {
+        std::fprintf(stderr, "没有找到输入图片：%s\n", qPrintable(options.input));
+        return 2;
+    }
+    if (!QDir().mkpath(options.outputDir))
+    {
+        std::fprintf(stderr, "无法创建输出目录：%s\n", qPrintable(options.outputDir));
+        return 2;
+    }
+
+    const std::string extension = "." + options.format.toLower().toStdString();
+    if (!cv::haveImageWriter("x" + extension))
+    {
+        std::fprintf(stderr, "OpenCV 不支持输出格式：%s\n", qPrintable(options.format));
+        return 2;
+    }
+
+    // 输出名只取输入的基本名：a.jpg 和 a.png 会写到同一个文件，后写的静默覆盖先写的。
+    // 排队前检查，发现冲突直接按参数错误退出
+    const QDir outputDir(options.outputDir);
+    QStringList outputs;
+    outputs.reserve(inputs.size());
+    QHash<QString, QString> sourceByOutput;
+    bool collision = false;
+    for (const QString &path : inputs)
+    {
+        const QString outputPath = outputDir.filePath(QFileInfo(path).completeBaseName() + extension.c_str());
+        const auto existing = sourceByOutput.constFind(outputPath);
+        if (existing != sourceByOutput.constEnd())
+        {
+            std::fprintf(stderr,
+                         "输出文件重名：%s 与 %s 都会写到 %s\n",
+                         qPrintable(existing.value()),
+                         qPrintable(path),
+                         qPrintable(outputPath));
+            collision = true;
+            continue;
+        }
+        sourceByOutput.insert(outputPath, path);
+        outputs.append(outputPath);
+    }
+    if (collision)
+    {
+        return 2;
+    }
+
+    const int jobs = options.jobs > 0 ? options.jobs : std::max(1, QThread::idealThreadCount());
+    const size_t depth = options.queueDepth > 0 ? options.queueDepth : static_cast<size_t>(2 * jobs);
+    // 读写是 I/O，编码比处理轻，按处理级的一半分配线程
+    const int ioThreads = std::max(1, std::min(jobs, 2));
+    const int encodeThreads = std::max(1, jobs / 2);
+
+    // 并行发生在图像之间，关掉 OpenCV 内部的 parallel_for_，避免 jobs × 核数 的超额订阅
+    const int previousCvThreads = cv::getNumThreads();
+    if (jobs > 1)
+    {
+        cv::setNumThreads(1);
+    }
+
+    BoundedQueue<BatchItem> toRead(depth);
+    BoundedQueue<BatchItem> toProcess(depth);
+    BoundedQueue<BatchItem> toEncode(depth);
+    BoundedQueue<BatchItem> toWrite(depth);
+    BatchStats stats;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::thread> readers = startStage(ioThreads, [&] {
+        BatchItem item;
+        while (toRead.pop(item))
+        {
+            QFile file(item.inputPath);
+            if (!file.open(QIODevice::ReadOnly))
+            {
+                stats.fail(item.inputPath, file.errorString());
+                continue;
+            }
+            try
+            {
+                item.fileData = file.readAll();
+            }
+            catch (const std::exception &e)
+            {
+                stats.fail(item.inputPath, QString::fromLocal8Bit(e.what()));
+                continue;
+            }
+            toProcess.push(std::move(item));
+        }
+    });
+    std::vector<std::thread> processors = startStage(jobs, [&] {
+        BatchItem item;
+        while (toProcess.pop(item))
+        {
+            try
+            {
+                const cv::Mat encoded(1, item.fileData.size(), CV_8U, item.fileData.data());
+                const cv::Mat bgr = cv::imdecode(encoded, cv::IMREAD_COLOR);
+                item.fileData.clear();
+                if (bgr.empty())
+                {
+                    stats.fail(item.inputPath, QStringLiteral("无法解码"));
+                    continue;
+                }
+                item.image = operation->apply(bgr, options.params);
+                stats.pixels.fetch_add(static_cast<qint64>(bgr.total()));
+            }
+            catch (const std::exception &e)
+            {
+                // 除 cv::Exception 外，大图加深队列时还可能是 std::bad_alloc；
+                // 任何异常逃出线程函数都会 std::terminate 整个批处理
+                stats.fail(item.inputPath, QString::fromLocal8Bit(e.what()));
+                continue;
+            }
+            toEncode.push(std::move(item));
+        }
+    });
+    std::vector<std::thread> encoders = startStage(encodeThreads, [&] {
+        BatchItem item;
+        while (toEncode.pop(item))
+        {
+            bool ok = false;
+            QString reason = QStringLiteral("编码失败");
+            try
+            {
+                ok = cv::imencode(extension, item.image, item.encoded);
+            }
+            catch (const std::exception &e)
+            {
+                reason = QStringLiteral("编码失败：%1").arg(QString::fromLocal8Bit(e.what()));
+            }
+            item.image.release();
+            if (!ok)
+            {
+                stats.fail(item.inputPath, reason);
+                continue;
+            }
+            toWrite.push(std::move(item));
+        }
+    });
+    std::vector<std::thread> writers = startStage(ioThreads, [&] {
+        BatchItem item;
+        while (toWrite.pop(item))
+        {
+            QFile file(item.outputPath);
+            const qint64 size = static_cast<qint64>(item.encoded.size());
+            if (!file.open(QIODevice::WriteOnly)
+                || file.write(reinterpret_cast<const char *>(item.encoded.data()), size) != size)
+            {
+                stats.fail(item.inputPath, file.errorString());
+                continue;
+            }
+            stats.succeed();
+        }
+    });
+
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        BatchItem item;
+        item.inputPath = inputs[i];
+        item.outputPath = outputs[i];
+        toRead.push(std::move(item));
+    }
+
+    // 按级关闭：上游线程全部退出后下游才能确定不会再有新元素
+    toRead.close();
+    joinAll(readers);
+    toProcess.close();
+    joinAll(processors);
+    toEncode.close();
+    joinAll(encoders);
+    toWrite.close();
+    joinAll(writers);
+
+    cv::setNumThreads(previousCvThreads);
+
+    const double seconds = std::max(1e-9, timer.nsecsElapsed() / 1e9);
+    std::printf("%s：%d 成功，%d 失败，共 %d 张，%.2f 秒，%.1f 张/秒，%.1f MPix/s（%d 个处理线程）\n",
+                operation->name.c_str(),
+                stats.succeeded.load(),
+                stats.failed.load(),
+                static_cast<int>(inputs.size()),
+                seconds,
+                stats.succeeded.load() / seconds,
+                stats.pixels.load() / 1e6 / seconds,
+                jobs);
+    return stats.failed.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "image_operations.h"
+
+// 命令行批处理：对目录（或通配符）下的所有图片执行同一个课程操作，
+// 按 读取 → 解码并处理 → 编码 → 写出 四级流水线并行运行。
+// 级与级之间是有界队列：下游跟不上时上游阻塞，内存中同时存在的图像数有上限。
+struct BatchOptions
+{
+    QString input;        // 目录，或带通配符的路径，如 images/*.jpg
+    QString outputDir;
+    QString format = QStringLiteral("png"); // 输出扩展名，交给 cv::imencode
+    std::string operation;
+    OperationParams params;
+    int jobs = 0;         // 处理级线程数，0 表示 QThread::idealThreadCount()
+    int queueDepth = 0;   // 每个队列的容量，0 表示 2 * jobs
+};
+
+// 展开输入目录/通配符，按文件名排序
+QStringList collectBatchInputs(const QString &input);
+
+// 返回进程退出码：全部成功为 0，有失败为 1，参数错误为 2
+int runBatch(const BatchOptions &options);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace bench
+{
+// 先预热一次，再运行 iterations 次，返回升序排列的单次耗时（毫秒）
+template <typename Fn>
+std::vector<double> measure(int iterations, Fn &&fn)
+{
+    fn();
+
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(iterations));
+    for (int i = 0; i < iterations; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+// samples 需已排序，p 取 0~1
+inline double percentile(const std::vector<double> &samples, double p)
+{
+    if (samples.empty())
+    {
+        return 0.0;
+    }
+    const auto index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+inline double megapixelsPerSecond(double pixels, double milliseconds)
+{
+    return milliseconds > 0.0 ? pixels / 1e6 / (milliseconds / 1e3) : 0.0;
+}
+} // namespace bench
@@ -0,0 +1,151 @@
+// matToQImage 微基准：对每种支持的像素格式报告中位耗时与 MPix/s，
+// 最后校验浮点映射对超大值和 ±inf 的饱和（SIMD 段与标量尾部一致）
+// 用法：mat_to_qimage_bench [宽度] [高度] [迭代次数]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include <opencv2/opencv.hpp>
+
+#include "../mat_to_qimage.h"
+#include "bench_common.h"
+
+namespace
+{
+struct FormatCase
+{
+    const char *name;
+    int type;
+    bool share;
+    ToneMapping toneMapping;
+};
+
+cv::Mat makeInput(int rows, int cols, int type)
+{
+    cv::Mat mat(rows, cols, type);
+    if (CV_MAT_DEPTH(type) == CV_32F)
+    {
+        cv::randu(mat, cv::Scalar::all(0.0), cv::Scalar::all(1.0));
+    }
+    else if (CV_MAT_DEPTH(type) == CV_16U)
+    {
+        cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(65536));
+    }
+    else
+    {
+        cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+    return mat;
+}
+
+// 一行 32FC1 样本循环填入超大值、±inf 和普通值，宽度覆盖多个向量和标量尾部；
+// 期望值按文档的公式在双精度下计算。普通值都避开 x.5，取整方式不影响结果。
+// 返回不一致的像素数
+int checkSaturation(const ToneMapping &toneMapping)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const float values[] = {0.25f, 1e30f, inf, -inf, -1e30f, 2.0f, 0.75f, -0.25f, 0.0f, 1.0f, 0.125f, 3e38f, -3e38f};
+    constexpr int kValueCount = sizeof(values) / sizeof(values[0]);
+    // 比 AVX-512 一次处理的 4 个向量（64 个样本）还宽，并留出不整除的尾部
+    const int cols = 3 * 64 + 7;
+    cv::Mat row(1, cols, CV_32FC1);
+    for (int x = 0; x < cols; ++x)
+    {
+        row.at<float>(0, x) = values[x % kValueCount];
+    }
+
+    const QImage image = matToQImage(row, toneMapping);
+    if (image.isNull())
+    {
+        return cols;
+    }
+    const bool useGamma = std::abs(toneMapping.gamma - 1.0) >= 1e-6;
+    const double high = useGamma ? 4095.0 : 255.0;
+    int mismatches = 0;
+    for (int x = 0; x < cols; ++x)
+    {
+        const double v = std::clamp(static_cast<double>(values[x % kValueCount]), 0.0, 1.0);
+        const double index = std::round(v * high);
+        const int expected = useGamma ? cv::saturate_cast<uchar>(std::pow(index / high, toneMapping.gamma) * 255.0)
+                                      : static_cast<int>(index);
+        const int actual = image.constScanLine(0)[x];
+        if (actual != expected)
+        {
+            std::fprintf(stderr, "saturation mismatch at %d (%g): got %d, expected %d\n", x,
+                         static_cast<double>(values[x % kValueCount]), actual, expected);
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int cols = argc > 1 ? std::atoi(argv[1]) : 4000;
+    const int rows = argc > 2 ? std::atoi(argv[2]) : 3000;
+    const int iterations = argc > 3 ? std::atoi(argv[3]) : 20;
+    if (cols <= 0 || rows <= 0 || iterations <= 0)
+    {
+        std::fprintf(stderr, "usage: %s [width] [height] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    ToneMapping gamma;
+    gamma.gamma = 0.45;
+    ToneMapping window;
+    window.windowLow = 1024.0;
+    window.windowHigh = 4095.0;
+
+    const FormatCase cases[] = {
+        {"8UC1 copy", CV_8UC1, false, {}},
+        {"8UC1 share", CV_8UC1, true, {}},
+        {"8UC2 gray+alpha", CV_8UC2, false, {}},
+        {"8UC3 copy", CV_8UC3, false, {}},
+        {"8UC3 share", CV_8UC3, true, {}},
+        {"8UC4 copy", CV_8UC4, false, {}},
+        {"8UC4 share", CV_8UC4, true, {}},
+        {"16UC1 linear", CV_16UC1, false, {}},
+        {"16UC1 window", CV_16UC1, false, window},
+        {"16UC3 linear", CV_16UC3, false, {}},
+        {"16UC3 gamma", CV_16UC3, false, gamma},
+        {"16UC4 linear", CV_16UC4, false, {}},
+        {"32FC1 linear", CV_32FC1, false, {}},
+        {"32FC1 gamma", CV_32FC1, false, gamma},
+        {"32FC3 linear", CV_32FC3, false, {}},
+        {"32FC3 gamma", CV_32FC3, false, gamma},
+    };
+
+    std::printf("matToQImage %dx%d, %d iterations, %d threads\n", cols, rows, iterations, cv::getNumThreads());
+    std::printf("%-18s %12s %12s %12s\n", "format", "median ms", "p99 ms", "MPix/s");
+
+    const double pixels = static_cast<double>(rows) * cols;
+    for (const FormatCase &c : cases)
+    {
+        const cv::Mat input = makeInput(rows, cols, c.type);
+        const bool highDepth = CV_MAT_DEPTH(c.type) != CV_8U;
+        const auto samples = bench::measure(iterations, [&]() {
+            const QImage image = highDepth ? matToQImage(input, c.toneMapping)
+                                           : matToQImage(input, c.share ? MatToQImageMode::Share : MatToQImageMode::Copy);
+            if (image.isNull())
+            {
+                std::fprintf(stderr, "conversion failed: %s\n", c.name);
+                std::exit(1);
+            }
+        });
+
+        const double median = bench::percentile(samples, 0.5);
+        std::printf("%-18s %12.3f %12.3f %12.1f\n",
+                    c.name,
+                    median,
+                    bench::percentile(samples, 0.99),
+                    bench::megapixelsPerSecond(pixels, median));
+    }
+
+    const int mismatches = checkSaturation(ToneMapping()) + checkSaturation(gamma);
+    std::printf("\n32FC1 saturation (huge / inf values): %s\n", mismatches == 0 ? "ok" : "MISMATCH, see stderr");
+    return mismatches == 0 ? 0 : 1;
+}
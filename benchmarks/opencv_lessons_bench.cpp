@@ -0,0 +1,242 @@
+// 课程操作回归基准：每个课程里的操作在“图像尺寸 × 线程数 × 输入类型”矩阵上各跑一遍，
+// 以 JSON 输出中位数/p99 延迟、MPix/s 和每次调用分配的字节数，便于不同版本之间对比
+// 用法：opencv_lessons_bench [迭代次数] [输出 JSON 文件，默认 stdout] [只跑名字包含该子串的操作]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "../color_adjust.h"
+#include "../fast_morphology.h"
+#include "../image_operations.h"
+#include "../mat_to_qimage.h"
+#include "../point_op_pipeline.h"
+#include "bench_common.h"
+
+namespace
+{
+// 包装 OpenCV 默认分配器，统计 Mat 像素缓冲区的分配量
+class CountingAllocator : public cv::MatAllocator
+{
+public:
+    explicit CountingAllocator(cv::MatAllocator *inner) : inner(inner) {}
+
+    cv::UMatData *allocate(int dims,
+                           const int *sizes,
+                           int type,
+                           void *data,
+                           size_t *step,
+                           cv::AccessFlag flags,
+                           cv::UMatUsageFlags usageFlags) const override
+    {
+        cv::UMatData *u = inner->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (u && !data)
+        {
+            bytes.fetch_add(u->size, std::memory_order_relaxed);
+            allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData *data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override
+    {
+        return inner->allocate(data, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData *data) const override { inner->deallocate(data); }
+
+    mutable std::atomic<size_t> bytes{0};
+    mutable std::atomic<size_t> allocations{0};
+
+private:
+    cv::MatAllocator *inner;
+};
+
+struct Operation
+{
+    const char *name;
+    std::vector<int> types;
+    // 每个 (尺寸, 类型) 组合调用一次，返回被计时的闭包；可在这里做不计时的准备工作
+    std::function<std::function<void()>(const cv::Mat &input)> prepare;
+};
+
+const std::vector<int> kGray = {CV_8UC1};
+const std::vector<int> kColor = {CV_8UC3};
+const std::vector<int> k8Bit = {CV_8UC1, CV_8UC3, CV_8UC4};
+
+std::function<void()> pointOp(const cv::Mat &input, const PointOpPipeline &ops)
+{
+    auto output = std::make_shared<cv::Mat>();
+    return [input, ops, output]() { ops.apply(input, *output); };
+}
+
+std::vector<Operation> operations()
+{
+    const cv::Mat element3 = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+    const cv::Mat element7 = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(7, 7));
+    return {
+        {"imwrite_png", k8Bit, [](const cv::Mat &input) -> std::function<void()> {
+             // 01 课的生成并保存，写内存而不写磁盘，避免文件系统抖动
+             auto buffer = std::make_shared<std::vector<uchar>>();
+             return [input, buffer]() { cv::imencode(".png", input, *buffer); };
+         }},
+        {"mat_to_qimage", {CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC3, CV_32FC3}, [](const cv::Mat &input) -> std::function<void()> {
+             return [input]() { (void)matToQImage(input, MatToQImageMode::Copy); };
+         }},
+        {"gamma_lut", k8Bit, [](const cv::Mat &input) { return pointOp(input, PointOpPipeline().gamma(0.6)); }},
+        {"histogram_equalize", {CV_8UC1, CV_8UC3}, [](const cv::Mat &input) -> std::function<void()> {
+             auto output = std::make_shared<cv::Mat>();
+             if (input.channels() == 1)
+             {
+                 return [input, output]() { cv::equalizeHist(input, *output); };
+             }
+             return [input, output]() { *output = equalizeLuminance(input); };
+         }},
+        {"truncate", k8Bit, [](const cv::Mat &input) { return pointOp(input, PointOpPipeline().truncate(120)); }},
+        {"color_adjust", kColor, [](const cv::Mat &input) -> std::function<void()> {
+             auto lut = std::make_shared<const ColorAdjustLut>(ColorAdjustParams());
+             auto output = std::make_shared<cv::Mat>();
+             return [input, lut, output]() { lut->apply(input, *output); };
+         }},
+        {"invert", k8Bit, [](const cv::Mat &input) { return pointOp(input, PointOpPipeline().invert()); }},
+        {"threshold", k8Bit, [](const cv::Mat &input) { return pointOp(input, PointOpPipeline().threshold(128)); }},
+        {"contrast_stretch", kGray, [](const cv::Mat &input) -> std::function<void()> {
+             // 与 12 课一致：每次都要先求 min/max 再建表
+             auto output = std::make_shared<cv::Mat>();
+             return [input, output]() {
+                 double minValue = 0.0;
+                 double maxValue = 0.0;
+                 cv::minMaxLoc(input, &minValue, &maxValue);
+                 PointOpPipeline().stretch(minValue, maxValue).apply(input, *output);
+             };
+         }},
+        {"erode_7x7", k8Bit, [element7](const cv::Mat &input) -> std::function<void()> {
+             auto output = std::make_shared<cv::Mat>();
+             return [input, element7, output]() { fastErode(input, *output, element7); };
+         }},
+        {"dilate_7x7", k8Bit, [element7](const cv::Mat &input) -> std::function<void()> {
+             auto output = std::make_shared<cv::Mat>();
+             return [input, element7, output]() { fastDilate(input, *output, element7); };
+         }},
+        {"boundary_3x3", kGray, [element3](const cv::Mat &input) -> std::function<void()> {
+             auto output = std::make_shared<cv::Mat>();
+             return [input, element3, output]() {
+                 morphGradient(input, *output, element3, MorphGradient::Internal);
+             };
+         }},
+    };
+}
+
+cv::Mat makeInput(cv::Size size, int type)
+{
+    cv::Mat input(size, type);
+    if (CV_MAT_DEPTH(type) == CV_32F)
+    {
+        cv::randu(input, cv::Scalar::all(0.0), cv::Scalar::all(1.0));
+    }
+    else if (CV_MAT_DEPTH(type) == CV_16U)
+    {
+        cv::randu(input, cv::Scalar::all(0), cv::Scalar::all(65536));
+    }
+    else
+    {
+        cv::randu(input, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+    return input;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 30;
+    const char *outputPath = argc > 2 && std::strcmp(argv[2], "-") != 0 ? argv[2] : nullptr;
+    const char *filter = argc > 3 ? argv[3] : nullptr;
+    if (iterations <= 0)
+    {
+        std::fprintf(stderr, "usage: %s [iterations] [output.json|-] [operation filter]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *out = outputPath ? std::fopen(outputPath, "w") : stdout;
+    if (!out)
+    {
+        std::fprintf(stderr, "cannot open %s\n", outputPath);
+        return 1;
+    }
+
+    CountingAllocator allocator(cv::Mat::getStdAllocator());
+    cv::Mat::setDefaultAllocator(&allocator);
+
+    const cv::Size sizes[] = {{640, 480}, {1920, 1080}, {4000, 3000}};
+    const int cpus = cv::getNumberOfCPUs();
+    std::vector<int> threadCounts = {1};
+    if (cpus > 1)
+    {
+        threadCounts.push_back(cpus);
+    }
+
+    std::fprintf(out, "{\n  \"opencv\": \"%s\",\n  \"cpus\": %d,\n  \"iterations\": %d,\n  \"results\": [",
+                 CV_VERSION, cpus, iterations);
+    bool first = true;
+    for (const Operation &operation : operations())
+    {
+        if (filter && !std::strstr(operation.name, filter))
+        {
+            continue;
+        }
+        for (const cv::Size size : sizes)
+        {
+            for (const int type : operation.types)
+            {
+                const cv::Mat input = makeInput(size, type);
+                const std::function<void()> run = operation.prepare(input);
+                for (const int threads : threadCounts)
+                {
+                    cv::setNumThreads(threads);
+                    run(); // 预热：输出缓冲区在这里分配，后续迭代统计的是稳态分配量
+                    const size_t bytesBefore = allocator.bytes.load();
+                    const size_t allocationsBefore = allocator.allocations.load();
+                    const std::vector<double> samples = bench::measure(iterations, run);
+                    // measure 内部还有一次预热调用
+                    const double calls = iterations + 1;
+                    const double bytes = (allocator.bytes.load() - bytesBefore) / calls;
+                    const double allocations = (allocator.allocations.load() - allocationsBefore) / calls;
+                    const double median = bench::percentile(samples, 0.5);
+
+                    std::fprintf(out,
+                                 "%s\n    {\"op\": \"%s\", \"width\": %d, \"height\": %d, \"type\": \"%s\", "
+                                 "\"threads\": %d, \"median_ms\": %.4f, \"p99_ms\": %.4f, \"mpix_per_s\": %.2f, "
+                                 "\"bytes_allocated\": %.0f, \"allocations\": %.2f}",
+                                 first ? "" : ",",
+                                 operation.name,
+                                 size.width,
+                                 size.height,
+                                 cv::typeToString(type).c_str(),
+                                 threads,
+                                 median,
+                                 bench::percentile(samples, 0.99),
+                                 bench::megapixelsPerSecond(static_cast<double>(size.area()), median),
+                                 bytes,
+                                 allocations);
+                    std::fflush(out);
+                    first = false;
+                }
+            }
+        }
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+
+    cv::Mat::setDefaultAllocator(nullptr);
+    if (out != stdout)
+    {
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "color_adjust.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "trace.h"
+
+namespace
+{
+constexpr int kGrid = ColorAdjustLut::kGridSize;
+
+// 每个 8 位取值在某一轴上落到哪两个格点之间，以及插值权重
+struct AxisTable
+{
+    std::array<int, 256> index;
+    std::array<float, 256> weight;
+};
+
+const AxisTable &axisTable()
+{
+    static const AxisTable table = [] {
+        AxisTable t;
+        for (int v = 0; v < 256; ++v)
+        {
+            const float position = static_cast<float>(v) * (kGrid - 1) / 255.0f;
+            const int index = std::min(static_cast<int>(position), kGrid - 2);
+            t.index[static_cast<size_t>(v)] = index;
+            t.weight[static_cast<size_t>(v)] = position - static_cast<float>(index);
+        }
+        return t;
+    }();
+    return table;
+}
+} // namespace
+
+ColorAdjustLut::ColorAdjustLut(const ColorAdjustParams &params)
+{
+    build(params);
+}
+
+void ColorAdjustLut::build(const ColorAdjustParams &params)
+{
+    TRACE_SCOPE("3D LUT build");
+    current = params;
+
+    // 所有格点颜色排成一行，借 OpenCV 的浮点 HSV 转换一次求值
+    cv::Mat samples(1, kGrid * kGrid * kGrid, CV_32FC3);
+    auto *sample = samples.ptr<cv::Vec3f>();
+    for (int b = 0; b < kGrid; ++b)
+    {
+        for (int g = 0; g < kGrid; ++g)
+        {
+            for (int r = 0; r < kGrid; ++r)
+            {
+                *sample++ = cv::Vec3f(b, g, r) * (1.0f / (kGrid - 1));
+            }
+        }
+    }
+
+    cv::Mat hsv;
+    cv::cvtColor(samples, hsv, cv::COLOR_BGR2HSV); // H: 0~360, S/V: 0~1
+    const float saturationOffset = static_cast<float>(params.saturationOffset / 255.0);
+    const float hueShift = static_cast<float>(params.hueShift);
+    cv::Mat_<cv::Vec3f> hsvPixels = hsv;
+    for (cv::Vec3f &pixel : hsvPixels)
+    {
+        pixel[0] = std::fmod(pixel[0] + hueShift + 360.0f, 360.0f);
+        pixel[1] = std::clamp(pixel[1] + saturationOffset, 0.0f, 1.0f);
+    }
+    cv::Mat adjusted;
+    cv::cvtColor(hsv, adjusted, cv::COLOR_HSV2BGR);
+
+    const float gains[3] = {static_cast<float>(params.blueGain * 255.0),
+                            static_cast<float>(params.greenGain * 255.0),
+                            static_cast<float>(params.redGain * 255.0)};
+    grid.resize(static_cast<size_t>(kGrid) * kGrid * kGrid);
+    const auto *out = adjusted.ptr<cv::Vec3f>();
+    for (size_t i = 0; i < grid.size(); ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            grid[i][c] = std::clamp(out[i][c] * gains[c], 0.0f, 255.0f);
+        }
+    }
+}
+
+const ColorAdjustParams &ColorAdjustLut::params() const
+{
+    return current;
+}
+
+void ColorAdjustLut::apply(const cv::Mat &bgr, cv::Mat &dst) const
+{
+    TRACE_SCOPE("3D LUT apply");
+    CV_Assert(bgr.type() == CV_8UC3);
+
+    const cv::Mat input = bgr;
+    dst.create(input.size(), CV_8UC3);
+    const AxisTable &axis = axisTable();
+    const cv::Vec3f *lut = grid.data();
+    constexpr int strideB = kGrid * kGrid;
+    constexpr int strideG = kGrid;
+
+    cv::parallel_for_(cv::Range(0, input.rows), [&](const cv::Range &range) {
+        for (int y = range.start; y < range.end; ++y)
+        {
+            const uchar *in = input.ptr<uchar>(y);
+            uchar *out = dst.ptr<uchar>(y);
+            for (int x = 0; x < input.cols; ++x, in += 3, out += 3)
+            {
+                const float wb = axis.weight[in[0]];
+                const float wg = axis.weight[in[1]];
+                const float wr = axis.weight[in[2]];
+                const cv::Vec3f *c000 = lut + axis.index[in[0]] * strideB + axis.index[in[1]] * strideG + axis.index[in[2]];
+                const cv::Vec3f *c100 = c000 + strideB;
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    // 先沿 R、再沿 G、最后沿 B 插值
+                    const float v00 = c000[0][c] + (c000[1][c] - c000[0][c]) * wr;
+                    const float v01 = c000[strideG][c] + (c000[strideG + 1][c] - c000[strideG][c]) * wr;
+                    const float v10 = c100[0][c] + (c100[1][c] - c100[0][c]) * wr;
+                    const float v11 = c100[strideG][c] + (c100[strideG + 1][c] - c100[strideG][c]) * wr;
+                    const float v0 = v00 + (v01 - v00) * wg;
+                    const float v1 = v10 + (v11 - v10) * wg;
+                    out[c] = static_cast<uchar>(v0 + (v1 - v0) * wb + 0.5f);
+                }
+            }
+        }
+    });
+}
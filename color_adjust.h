@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// 颜色调整参数：先在 HSV 空间调整饱和度/色相，再对 B/G/R 各乘增益
+struct ColorAdjustParams
+{
+    double saturationOffset = 40.0; // 加到 S 上，以 0~255 计
+    double hueShift = 0.0;          // 色相偏移，单位为度
+    double blueGain = 0.8;
+    double greenGain = 1.0;
+    double redGain = 1.2;
+};
+
+// 把颜色调整编译成 33x33x33 的 3D 查找表，再用三线性插值单遍作用于整幅 BGR 图像：
+// 原来的 cvtColor → split → add → merge → cvtColor → split → convertTo ×2 → merge
+// 共 9 遍并产生十几个临时 Mat；这里构建查表只需计算 33³ 个格点，应用时每个像素读一次写一次。
+// 格点按连续（浮点）HSV 模型求值，与 8 位 HSV 流水线相比差异在 1~2 个灰阶以内，
+// 但不再有 8 位 H 通道只有 180 级带来的色相量化。
+class ColorAdjustLut
+{
+public:
+    static constexpr int kGridSize = 33;
+
+    // 构造时即按 params 构建格点；之后参数变化时再调用 build
+    explicit ColorAdjustLut(const ColorAdjustParams &params = ColorAdjustParams());
+
+    void build(const ColorAdjustParams &params);
+    const ColorAdjustParams &params() const;
+
+    // bgr 必须是 CV_8UC3，dst 为 CV_8UC3
+    void apply(const cv::Mat &bgr, cv::Mat &dst) const;
+
+private:
+    ColorAdjustParams current;
+    std::vector<cv::Vec3f> grid; // 下标 (b * 33 + g) * 33 + r
+};
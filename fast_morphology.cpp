@@ -0,0 +1,534 @@
+#include "fast_morphology.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace
+{
+// 相对锚点的矩形：覆盖 x ∈ [x - left, x + right]，y ∈ [y - up, y + down]
+struct RectPart
+{
+    int left;
+    int right;
+    int up;
+    int down;
+};
+
+// 按行程把结构元素分解为矩形的并集：每个不同的行程 [s, e] 对应一个矩形，
+// 其高度是行程包含 [s, e] 的连续行。任一行不是单段时返回空。
+std::vector<RectPart> decompose(const cv::Mat &element)
+{
+    const cv::Point anchor(element.cols / 2, element.rows / 2);
+    std::vector<cv::Vec2i> runs(static_cast<size_t>(element.rows), cv::Vec2i(-1, -1));
+    for (int y = 0; y < element.rows; ++y)
+    {
+        const uchar *row = element.ptr<uchar>(y);
+        int start = -1;
+        int end = -1;
+        for (int x = 0; x < element.cols; ++x)
+        {
+            if (!row[x])
+            {
+                continue;
+            }
+            if (start < 0)
+            {
+                start = x;
+            }
+            else if (x != end + 1)
+            {
+                return {};
+            }
+            end = x;
+        }
+        runs[static_cast<size_t>(y)] = cv::Vec2i(start, end);
+    }
+
+    std::vector<RectPart> parts;
+    std::vector<cv::Vec2i> seen;
+    for (int y = 0; y < element.rows; ++y)
+    {
+        const cv::Vec2i run = runs[static_cast<size_t>(y)];
+        if (run[0] < 0 || std::find(seen.begin(), seen.end(), run) != seen.end())
+        {
+            continue;
+        }
+        seen.push_back(run);
+
+        int top = y;
+        int bottom = y;
+        const auto covers = [&](int row) {
+            const cv::Vec2i r = runs[static_cast<size_t>(row)];
+            return r[0] >= 0 && r[0] <= run[0] && r[1] >= run[1];
+        };
+        while (top > 0 && covers(top - 1))
+        {
+            --top;
+        }
+        while (bottom + 1 < element.rows && covers(bottom + 1))
+        {
+            ++bottom;
+        }
+        // 只有包含它的行连续时分解才精确
+        for (int row = 0; row < element.rows; ++row)
+        {
+            if ((row < top || row > bottom) && covers(row))
+            {
+                return {};
+            }
+        }
+        parts.push_back({anchor.x - run[0], run[1] - anchor.x, anchor.y - top, bottom - anchor.y});
+    }
+
+    // 被其他矩形完全包含的矩形不影响结果
+    std::vector<RectPart> reduced;
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        bool contained = false;
+        for (size_t j = 0; j < parts.size() && !contained; ++j)
+        {
+            // 行程互不相同，所以不会出现两个完全相同的矩形
+            contained = j != i && parts[j].left >= parts[i].left && parts[j].right >= parts[i].right &&
+                        parts[j].up >= parts[i].up && parts[j].down >= parts[i].down;
+        }
+        if (!contained)
+        {
+            reduced.push_back(parts[i]);
+        }
+    }
+    return reduced;
+}
+
+bool isCancelled(const MorphCancel &cancelled)
+{
+    return cancelled && cancelled();
+}
+
+template <typename T, bool IsMin>
+struct Extremum
+{
+    static T identity()
+    {
+        // 与 cv::morphologyDefaultBorderValue 一致：腐蚀时边界视为最大值，膨胀时视为最小值
+        return IsMin ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+    }
+    static T apply(T a, T b)
+    {
+        return IsMin ? std::min(a, b) : std::max(a, b);
+    }
+};
+
+// 行方向：out[x] = op(in[x - left .. x + right])，按 stride 跳过交错的其他通道
+template <typename T, typename Op>
+void runningExtremumRow(const T *in, T *out, int n, int stride, int left, int right, std::vector<T> &g, std::vector<T> &h)
+{
+    const int k = left + right + 1;
+    const int padded = (n + k - 1 + k - 1) / k * k;
+    g.resize(static_cast<size_t>(padded));
+    h.resize(static_cast<size_t>(padded));
+    const T identity = Op::identity();
+    const auto value = [&](int p) {
+        const int x = p - left;
+        return x >= 0 && x < n ? in[static_cast<std::ptrdiff_t>(x) * stride] : identity;
+    };
+
+    // g：块内前缀，h：块内后缀，块长为 k
+    for (int block = 0; block < padded; block += k)
+    {
+        g[static_cast<size_t>(block)] = value(block);
+        for (int p = block + 1; p < block + k; ++p)
+        {
+            g[static_cast<size_t>(p)] = Op::apply(g[static_cast<size_t>(p - 1)], value(p));
+        }
+        h[static_cast<size_t>(block + k - 1)] = value(block + k - 1);
+        for (int p = block + k - 2; p >= block; --p)
+        {
+            h[static_cast<size_t>(p)] = Op::apply(h[static_cast<size_t>(p + 1)], value(p));
+        }
+    }
+    for (int x = 0; x < n; ++x)
+    {
+        out[static_cast<std::ptrdiff_t>(x) * stride] = Op::apply(h[static_cast<size_t>(x)], g[static_cast<size_t>(x + k - 1)]);
+    }
+}
+
+template <typename T, typename Op>
+void horizontalPass(const cv::Mat &src, cv::Mat &dst, int left, int right, const MorphCancel &cancelled)
+{
+    const int channels = src.channels();
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range &range) {
+        std::vector<T> g;
+        std::vector<T> h;
+        for (int y = range.start; y < range.end; ++y)
+        {
+            if (isCancelled(cancelled))
+            {
+                return;
+            }
+            const T *in = src.ptr<T>(y);
+            T *out = dst.ptr<T>(y);
+            for (int c = 0; c < channels; ++c)
+            {
+                runningExtremumRow<T, Op>(in + c, out + c, src.cols, channels, left, right, g, h);
+            }
+        }
+    });
+}
+
+// 列方向：按列条带处理，每次只保留相邻两个块（各 k 行）的前缀/后缀，
+// 条带宽度让工作集留在缓存里，内层循环沿行连续访问，便于编译器向量化
+template <typename T, typename Op>
+void verticalPass(const cv::Mat &src, cv::Mat &dst, int up, int down, const MorphCancel &cancelled)
+{
+    const int k = up + down + 1;
+    const int width = src.cols * src.channels();
+    const int rows = src.rows;
+    const int stripWidth = std::max(16, static_cast<int>(512 / sizeof(T)));
+    const int strips = (width + stripWidth - 1) / stripWidth;
+    const T identity = Op::identity();
+
+    cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+        std::vector<T> buffers(static_cast<size_t>(4) * k * stripWidth);
+        T *gCurrent = buffers.data();
+        T *hCurrent = gCurrent + static_cast<size_t>(k) * stripWidth;
+        T *gNext = hCurrent + static_cast<size_t>(k) * stripWidth;
+        T *hNext = gNext + static_cast<size_t>(k) * stripWidth;
+
+        for (int strip = range.start; strip < range.end; ++strip)
+        {
+            const int x0 = strip * stripWidth;
+            const int w = std::min(stripWidth, width - x0);
+
+            // 计算填充坐标下从 block 开始的 k 行的前缀 g 与后缀 h
+            const auto buildBlock = [&](int block, T *g, T *h) {
+                for (int i = 0; i < k; ++i)
+                {
+                    const int y = block + i - up;
+                    const T *in = y >= 0 && y < rows ? src.ptr<T>(y) + x0 : nullptr;
+                    T *gRow = g + static_cast<size_t>(i) * stripWidth;
+                    const T *gPrev = i > 0 ? gRow - stripWidth : nullptr;
+                    for (int x = 0; x < w; ++x)
+                    {
+                        const T v = in ? in[x] : identity;
+                        gRow[x] = gPrev ? Op::apply(gPrev[x], v) : v;
+                    }
+                }
+                for (int i = k - 1; i >= 0; --i)
+                {
+                    const int y = block + i - up;
+                    const T *in = y >= 0 && y < rows ? src.ptr<T>(y) + x0 : nullptr;
+                    T *hRow = h + static_cast<size_t>(i) * stripWidth;
+                    const T *hBelow = i < k - 1 ? hRow + stripWidth : nullptr;
+                    for (int x = 0; x < w; ++x)
+                    {
+                        const T v = in ? in[x] : identity;
+                        hRow[x] = hBelow ? Op::apply(hBelow[x], v) : v;
+                    }
+                }
+            };
+
+            buildBlock(0, gCurrent, hCurrent);
+            for (int block = 0; block < rows; block += k)
+            {
+                if (isCancelled(cancelled))
+                {
+                    return;
+                }
+                buildBlock(block + k, gNext, hNext);
+                const int blockEnd = std::min(block + k, rows);
+                for (int y = block; y < blockEnd; ++y)
+                {
+                    // 窗口 [y, y + k - 1]（填充坐标）：当前块的后缀 + 下一块的前缀
+                    const int i = y - block;
+                    const T *hRow = hCurrent + static_cast<size_t>(i) * stripWidth;
+                    const T *gRow = i == 0 ? gCurrent + static_cast<size_t>(k - 1) * stripWidth
+                                           : gNext + static_cast<size_t>(i - 1) * stripWidth;
+                    T *out = dst.ptr<T>(y) + x0;
+                    for (int x = 0; x < w; ++x)
+                    {
+                        out[x] = Op::apply(hRow[x], gRow[x]);
+                    }
+                }
+                std::swap(gCurrent, gNext);
+                std::swap(hCurrent, hNext);
+            }
+        }
+    });
+}
+
+template <typename T, bool IsMin>
+void vanHerk(const cv::Mat &src, cv::Mat &dst, const std::vector<RectPart> &parts, const MorphCancel &cancelled)
+{
+    using Op = Extremum<T, IsMin>;
+    cv::Mat horizontal;
+    cv::Mat part;
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        if (isCancelled(cancelled))
+        {
+            return;
+        }
+        const RectPart &rect = parts[i];
+        cv::Mat &target = i == 0 ? dst : part;
+        target.create(src.size(), src.type());
+
+        // 行程不经过锚点时 left/right（up/down）有一个为负，窗口宽度为 1 也仍需平移，不能按和判断
+        const bool needsRow = rect.left != 0 || rect.right != 0;
+        const bool needsColumn = rect.up != 0 || rect.down != 0;
+        if (needsRow)
+        {
+            cv::Mat &rowTarget = needsColumn ? horizontal : target;
+            rowTarget.create(src.size(), src.type());
+            horizontalPass<T, Op>(src, rowTarget, rect.left, rect.right, cancelled);
+        }
+        if (needsColumn)
+        {
+            verticalPass<T, Op>(needsRow ? horizontal : src, target, rect.up, rect.down, cancelled);
+        }
+        if (!needsRow && !needsColumn)
+        {
+            src.copyTo(target);
+        }
+
+        if (i > 0)
+        {
+            if (IsMin)
+            {
+                cv::min(dst, part, dst);
+            }
+            else
+            {
+                cv::max(dst, part, dst);
+            }
+        }
+    }
+}
+
+template <bool IsMin>
+bool runVanHerk(const cv::Mat &src, cv::Mat &dst, const std::vector<RectPart> &parts, const MorphCancel &cancelled)
+{
+    switch (src.depth())
+    {
+    case CV_8U:
+        vanHerk<uchar, IsMin>(src, dst, parts, cancelled);
+        return true;
+    case CV_16U:
+        vanHerk<ushort, IsMin>(src, dst, parts, cancelled);
+        return true;
+    case CV_16S:
+        vanHerk<short, IsMin>(src, dst, parts, cancelled);
+        return true;
+    case CV_32F:
+        vanHerk<float, IsMin>(src, dst, parts, cancelled);
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 首次遇到一组输入时每个后端计时的次数，取最短的一次，排除冷缓存、首次分配和线程池启动的影响
+constexpr int kTuneRuns = 3;
+
+// 自动调优表：key = (核宽, 核高, 矩形数, 类型, log2(像素数))
+using TuneKey = std::tuple<int, int, int, int, int>;
+
+std::mutex &tuneMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<TuneKey, MorphBackend> &tuneTable()
+{
+    static std::map<TuneKey, MorphBackend> table;
+    return table;
+}
+
+TuneKey tuneKey(const cv::Mat &src, const cv::Mat &element, size_t partCount)
+{
+    const int sizeBucket = static_cast<int>(std::log2(std::max(1.0, static_cast<double>(src.total()))));
+    return TuneKey(element.cols, element.rows, static_cast<int>(partCount), src.type(), sizeBucket);
+}
+
+template <bool IsMin>
+void morph(const cv::Mat &src, cv::Mat &dst, const cv::Mat &element, MorphBackend backend, const MorphCancel &cancelled)
+{
+    if (isCancelled(cancelled))
+    {
+        return;
+    }
+
+    const auto runOpenCV = [&](cv::Mat &out) {
+        if (IsMin)
+        {
+            cv::erode(src, out, element);
+        }
+        else
+        {
+            cv::dilate(src, out, element);
+        }
+    };
+
+    const std::vector<RectPart> parts = backend == MorphBackend::OpenCV ? std::vector<RectPart>() : decompose(element);
+    const bool supported = !parts.empty() && (src.depth() == CV_8U || src.depth() == CV_16U ||
+                                              src.depth() == CV_16S || src.depth() == CV_32F);
+    if (!supported)
+    {
+        runOpenCV(dst);
+        return;
+    }
+
+    // 输出与输入共用缓冲区时先写到新 Mat，行列两遍都不能原地进行
+    cv::Mat output = dst.data == src.data ? cv::Mat() : dst;
+
+    if (backend == MorphBackend::Auto)
+    {
+        const TuneKey key = tuneKey(src, element, parts.size());
+        {
+            std::lock_guard<std::mutex> lock(tuneMutex());
+            const auto it = tuneTable().find(key);
+            if (it != tuneTable().end())
+            {
+                backend = it->second;
+            }
+        }
+
+        if (backend == MorphBackend::Auto)
+        {
+            // 首次遇到：两种后端交替各跑 kTuneRuns 次，各取最短时间，输出保留 OpenCV 的结果（二者一致）
+            using Clock = std::chrono::steady_clock;
+            Clock::duration openCVTime = Clock::duration::max();
+            Clock::duration vanHerkTime = Clock::duration::max();
+            cv::Mat candidate;
+            for (int run = 0; run < kTuneRuns; ++run)
+            {
+                const auto start = Clock::now();
+                runOpenCV(output);
+                const auto middle = Clock::now();
+                runVanHerk<IsMin>(src, candidate, parts, cancelled);
+                const auto end = Clock::now();
+                dst = output;
+                if (isCancelled(cancelled))
+                {
+                    // 被提前取消的计时不可信，下次再测
+                    return;
+                }
+                openCVTime = std::min(openCVTime, middle - start);
+                vanHerkTime = std::min(vanHerkTime, end - middle);
+            }
+
+            backend = vanHerkTime < openCVTime ? MorphBackend::VanHerk : MorphBackend::OpenCV;
+            std::lock_guard<std::mutex> lock(tuneMutex());
+            tuneTable()[key] = backend;
+            return;
+        }
+    }
+
+    if (backend == MorphBackend::VanHerk)
+    {
+        runVanHerk<IsMin>(src, output, parts, cancelled);
+    }
+    else
+    {
+        runOpenCV(output);
+    }
+    dst = output;
+}
+} // namespace
+
+void fastErode(const cv::Mat &src, cv::Mat &dst, const cv::Mat &element, MorphBackend backend, const MorphCancel &cancelled)
+{
+    morph<true>(src, dst, element, backend, cancelled);
+}
+
+void fastDilate(const cv::Mat &src, cv::Mat &dst, const cv::Mat &element, MorphBackend backend, const MorphCancel &cancelled)
+{
+    morph<false>(src, dst, element, backend, cancelled);
+}
+
+MorphBackend tunedMorphBackend(const cv::Mat &src, const cv::Mat &element)
+{
+    const std::vector<RectPart> parts = decompose(element);
+    if (parts.empty())
+    {
+        return MorphBackend::OpenCV;
+    }
+    std::lock_guard<std::mutex> lock(tuneMutex());
+    const auto it = tuneTable().find(tuneKey(src, element, parts.size()));
+    return it != tuneTable().end() ? it->second : MorphBackend::Auto;
+}
+
+void morphGradient(const cv::Mat &src,
+                   cv::Mat &dst,
+                   const cv::Mat &element,
+                   MorphGradient kind,
+                   MorphBackend backend,
+                   const MorphCancel &cancelled)
+{
+    CV_Assert(!src.empty() && dst.data != src.data);
+    dst.create(src.size(), src.type());
+
+    const int up = element.rows / 2;
+    const int down = element.rows - 1 - up;
+    // 行带内容（含 halo）控制在约 256 KB，同时让 halo 只占行带的一小部分
+    const size_t rowBytes = std::max<size_t>(1, src.cols * src.elemSize());
+    const int bandRows = std::max({16, 4 * (up + down), static_cast<int>((256 * 1024) / rowBytes)});
+    const int bands = (src.rows + bandRows - 1) / bandRows;
+
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+        cv::Mat eroded;
+        cv::Mat dilated;
+        for (int band = range.start; band < range.end; ++band)
+        {
+            if (isCancelled(cancelled))
+            {
+                return;
+            }
+            const int y0 = band * bandRows;
+            const int y1 = std::min(src.rows, y0 + bandRows);
+            // 多取上下 halo 行，行带边缘的结果与整幅计算一致；图像真正的上下边界仍按默认边界处理
+            const int haloTop = std::max(0, y0 - up);
+            const int haloBottom = std::min(src.rows, y1 + down);
+            const cv::Mat input = src.rowRange(haloTop, haloBottom);
+            const cv::Rect inner(0, y0 - haloTop, src.cols, y1 - y0);
+            const cv::Mat center = input(inner);
+            cv::Mat out = dst.rowRange(y0, y1);
+
+            if (kind != MorphGradient::External)
+            {
+                fastErode(input, eroded, element, backend, cancelled);
+            }
+            if (kind != MorphGradient::Internal)
+            {
+                fastDilate(input, dilated, element, backend, cancelled);
+            }
+
+            if (isCancelled(cancelled))
+            {
+                return;
+            }
+            switch (kind)
+            {
+            case MorphGradient::Internal:
+                cv::subtract(center, eroded(inner), out);
+                break;
+            case MorphGradient::External:
+                cv::subtract(dilated(inner), center, out);
+                break;
+            case MorphGradient::Symmetric:
+                cv::subtract(dilated(inner), eroded(inner), out);
+                break;
+            }
+        }
+    });
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <functional>
+
+// 大核腐蚀/膨胀：
+// - VanHerk 后端用 van Herk/Gil-Werman 算法做行、列两遍滑动最小/最大值，
+//   每个像素约 3 次比较，与核大小无关；
+// - 十字、椭圆等非矩形结构元素按行程分解成若干矩形的并集，对各矩形结果再取最小/最大；
+// - Auto 按 (核尺寸, 分解出的矩形数, 类型, 图像尺寸档位) 首次调用时把两种后端各跑 3 次、取最短时间比较，
+//   之后沿用较快者。
+// 结果与 cv::erode/cv::dilate（默认锚点、默认常数边界、iterations = 1）逐像素一致，
+// 包括行程不经过锚点的自定义结构元素。
+// 支持 CV_8U/16U/16S/32F 任意通道数；结构元素的每一行必须是连续的一段（矩形、十字、椭圆都满足），
+// 否则自动退回 OpenCV 实现。
+enum class MorphBackend
+{
+    Auto,
+    OpenCV,
+    VanHerk
+};
+
+// 可选的取消检查：VanHerk 后端在行方向每一行、列方向每个 k 行的块之前调用，OpenCV 后端只在开始前检查。
+// 返回 true 时函数尽快返回，此时 dst 的内容未定义，调用方应丢弃它
+using MorphCancel = std::function<bool()>;
+
+void fastErode(const cv::Mat &src,
+               cv::Mat &dst,
+               const cv::Mat &element,
+               MorphBackend backend = MorphBackend::Auto,
+               const MorphCancel &cancelled = {});
+void fastDilate(const cv::Mat &src,
+                cv::Mat &dst,
+                const cv::Mat &element,
+                MorphBackend backend = MorphBackend::Auto,
+                const MorphCancel &cancelled = {});
+
+// Auto 对这组输入会选择哪个后端（未测过时返回 Auto）
+MorphBackend tunedMorphBackend(const cv::Mat &src, const cv::Mat &element);
+
+// 形态学梯度：Internal = src - erode(src)，External = dilate(src) - src，Symmetric = dilate(src) - erode(src)
+enum class MorphGradient
+{
+    Internal,
+    External,
+    Symmetric
+};
+
+// 按行带分块、多线程一遍完成：每个行带连同上下 halo 单独腐蚀/膨胀并立即相减，
+// 中间结果只有行带大小，不会生成整幅腐蚀图，峰值内存和访存量约为“先腐蚀再 absdiff”的一半。
+// dst 不能与 src 共用缓冲区。cancelled 在每个行带之前检查，并传给行带内的腐蚀/膨胀。
+void morphGradient(const cv::Mat &src,
+                   cv::Mat &dst,
+                   const cv::Mat &element,
+                   MorphGradient kind,
+                   MorphBackend backend = MorphBackend::Auto,
+                   const MorphCancel &cancelled = {});
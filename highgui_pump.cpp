@@ -0,0 +1,145 @@
+#include "highgui_pump.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+namespace
+{
+// 与 namedWindow 课程一致：从构建信息的 “GUI:” 行判断 HighGUI 后端
+bool openCvUsesQtBackend()
+{
+    const QStringList lines = QString::fromStdString(cv::getBuildInformation()).split('\n');
+    for (const QString &line : lines)
+    {
+        const QString trimmed = line.trimmed();
+        if (trimmed.startsWith(QStringLiteral("GUI:")))
+        {
+            return trimmed.contains(QStringLiteral("QT"), Qt::CaseInsensitive);
+        }
+    }
+    return false;
+}
+} // namespace
+
+HighGuiPump &HighGuiPump::instance()
+{
+    // 以 QCoreApplication 为 parent，随应用一起销毁
+    static HighGuiPump *pump = new HighGuiPump(QCoreApplication::instance());
+    return *pump;
+}
+
+HighGuiPump::HighGuiPump(QObject *parent)
+    : QObject(parent)
+{
+    qtBackend = openCvUsesQtBackend();
+    clock.start();
+
+    timer = new QTimer(this);
+    timer->setInterval(30);
+    connect(timer, &QTimer::timeout, this, [this]() {
+        pump();
+    });
+}
+
+void HighGuiPump::watchWindow(const std::string &windowName)
+{
+    windows.insert(windowName);
+    updateTimer();
+}
+
+void HighGuiPump::unwatchWindow(const std::string &windowName)
+{
+    windows.erase(windowName);
+    updateTimer();
+}
+
+bool HighGuiPump::usesQtEventLoop() const
+{
+    return qtBackend;
+}
+
+bool HighGuiPump::isRunning() const
+{
+    return timer->isActive();
+}
+
+std::uint64_t HighGuiPump::totalWakeups() const
+{
+    return wakeups;
+}
+
+int HighGuiPump::wakeupsPerSecond()
+{
+    const qint64 now = clock.elapsed();
+    while (!recentWakeups.empty() && now - recentWakeups.front() > 1000)
+    {
+        recentWakeups.pop_front();
+    }
+    return static_cast<int>(recentWakeups.size());
+}
+
+// 窗口已被用户关闭（或根本不存在）时返回 false
+bool HighGuiPump::isWindowOpen(const std::string &windowName)
+{
+    try
+    {
+        return cv::getWindowProperty(windowName, cv::WND_PROP_VISIBLE) >= 1.0;
+    }
+    catch (const cv::Exception &)
+    {
+        return false;
+    }
+}
+
+void HighGuiPump::closeWindow(const std::string &windowName)
+{
+    unwatchWindow(windowName);
+    if (isWindowOpen(windowName))
+    {
+        cv::destroyWindow(windowName);
+    }
+}
+
+void HighGuiPump::pump()
+{
+    ++wakeups;
+    recentWakeups.push_back(clock.elapsed());
+    wakeupsPerSecond();
+
+    // GTK/Win32 等后端需要 waitKey 来派发窗口事件（重绘、滑动条、鼠标回调）
+    cv::waitKey(1);
+
+    // 用户点了窗口的关闭按钮：注销，全部关闭后停止定时器
+    std::vector<std::string> closed;
+    for (const std::string &windowName : windows)
+    {
+        if (!isWindowOpen(windowName))
+        {
+            closed.push_back(windowName);
+        }
+    }
+    for (const std::string &windowName : closed)
+    {
+        windows.erase(windowName);
+    }
+    updateTimer();
+}
+
+void HighGuiPump::updateTimer()
+{
+    const bool needsPolling = !qtBackend && !windows.empty();
+    if (needsPolling && !timer->isActive())
+    {
+        timer->start();
+    }
+    else if (!needsPolling && timer->isActive())
+    {
+        timer->stop();
+    }
+}
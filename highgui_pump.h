@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <cstdint>
+#include <deque>
+#include <set>
+#include <string>
+
+class QTimer;
+
+// 全进程共享的 HighGUI 事件泵，取代每个课程各自的 30 ms waitKey 定时器。
+// - 只有存在已登记的 OpenCV 窗口时才运行；窗口被用户关闭后自动注销，全部关闭后定时器停止；
+// - OpenCV 使用 Qt 后端时，窗口事件本来就由应用的 Qt 事件循环处理，完全不需要轮询；
+// - 提供唤醒次数统计，便于确认空闲时 CPU 占用为零。
+// 只能在 GUI 线程使用。
+class HighGuiPump : public QObject
+{
+public:
+    static HighGuiPump &instance();
+
+    // 在 namedWindow 之后调用；同名窗口重复登记只算一次
+    void watchWindow(const std::string &windowName);
+    // 代码里 destroyWindow 之后调用
+    void unwatchWindow(const std::string &windowName);
+    // 注销并销毁窗口；窗口已被用户关闭时只注销
+    void closeWindow(const std::string &windowName);
+    // 窗口仍然打开（没有被用户关闭）
+    static bool isWindowOpen(const std::string &windowName);
+
+    bool usesQtEventLoop() const;
+    bool isRunning() const;
+    std::uint64_t totalWakeups() const;
+    // 最近一秒内的唤醒次数
+    int wakeupsPerSecond();
+
+private:
+    explicit HighGuiPump(QObject *parent);
+
+    void pump();
+    void updateTimer();
+
+    QTimer *timer = nullptr;
+    std::set<std::string> windows;
+    bool qtBackend = false;
+    std::uint64_t wakeups = 0;
+    QElapsedTimer clock;
+    std::deque<qint64> recentWakeups;
+};
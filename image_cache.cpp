@@ -0,0 +1,298 @@
+#include "image_cache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <functional>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "memory_accounting.h"
+#include "trace.h"
+
+namespace
+{
+size_t matBytes(const cv::Mat &mat)
+{
+    return mat.total() * mat.elemSize();
+}
+
+cv::Mat convert(const cv::Mat &source, ImageCache::Derived kind)
+{
+    TRACE_SCOPE("cvtColor");
+    memory_accounting::Scope tag(memory_accounting::kSharedLesson, "derived");
+    const int channels = source.channels();
+    cv::Mat converted;
+    if (kind == ImageCache::Derived::Gray)
+    {
+        if (channels == 1)
+        {
+            return source;
+        }
+        cv::cvtColor(source, converted, channels == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        return converted;
+    }
+
+    // YCrCb/HSV 只定义在三通道上，先统一成 BGR
+    cv::Mat bgr = source;
+    if (channels == 1)
+    {
+        cv::cvtColor(source, bgr, cv::COLOR_GRAY2BGR);
+    }
+    else if (channels == 4)
+    {
+        cv::cvtColor(source, bgr, cv::COLOR_BGRA2BGR);
+    }
+    cv::cvtColor(bgr, converted, kind == ImageCache::Derived::YCrCb ? cv::COLOR_BGR2YCrCb : cv::COLOR_BGR2HSV);
+    return converted;
+}
+} // namespace
+
+size_t ImageCache::KeyHash::operator()(const Key &key) const
+{
+    size_t seed = std::hash<std::string>()(key.path);
+    const auto combine = [&seed](size_t value) {
+        seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    };
+    combine(std::hash<qint64>()(key.modifiedMs));
+    combine(std::hash<qint64>()(key.fileSize));
+    combine(std::hash<int>()(key.flags));
+    return seed;
+}
+
+ImageCache::Key ImageCache::makeKey(const QFileInfo &info, int flags)
+{
+    Key key;
+    key.path = info.absoluteFilePath().toStdString();
+    key.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+    key.fileSize = info.size();
+    key.flags = flags;
+    return key;
+}
+
+ImageCache &ImageCache::instance()
+{
+    static ImageCache cache;
+    return cache;
+}
+
+cv::Mat ImageCache::imread(const QString &path, int flags)
+{
+    const QFileInfo info(path);
+    if (!info.exists())
+    {
+        // 文件不存在时不缓存，直接交给 imread 返回空 Mat
+        TRACE_SCOPE("imread");
+        return cv::imread(path.toStdString(), flags);
+    }
+
+    const Key key = makeKey(info, flags);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = index.find(key);
+        if (it != index.end())
+        {
+            // 命中：移到链表头部，标记为最近使用
+            entries.splice(entries.begin(), entries, it->second);
+            ++hits;
+            return it->second->image;
+        }
+        ++misses;
+    }
+
+    // 解码放在锁外，避免一张大图阻塞其他线程的查询
+    cv::Mat image;
+    {
+        TRACE_SCOPE("imread");
+        memory_accounting::Scope tag(memory_accounting::kSharedLesson, "image cache");
+        image = cv::imread(key.path, flags);
+    }
+    if (image.empty())
+    {
+        return image;
+    }
+
+    const size_t bytes = matBytes(image);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bytes > budgetBytes)
+    {
+        // 单张就超出预算：照常返回，但不占用缓存
+        return image;
+    }
+
+    const auto it = index.find(key);
+    if (it != index.end())
+    {
+        // 另一个线程已经解码并放入缓存，统一返回缓存里的那一份，保证各课程共享同一个 Mat
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->image;
+    }
+
+    entries.push_front(Entry{key, image, {}, bytes});
+    index.emplace(key, entries.begin());
+    bySource.emplace(image.data, entries.begin());
+    usedBytes += bytes;
+    evictLocked();
+    return image;
+}
+
+cv::Mat ImageCache::lookup(const QString &path, int flags)
+{
+    const QFileInfo info(path);
+    if (!info.exists())
+    {
+        return {};
+    }
+
+    const Key key = makeKey(info, flags);
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = index.find(key);
+    if (it == index.end())
+    {
+        return {};
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    ++hits;
+    return it->second->image;
+}
+
+cv::Mat ImageCache::derived(const cv::Mat &source, Derived kind)
+{
+    if (source.empty())
+    {
+        return {};
+    }
+    const auto slot = static_cast<size_t>(kind);
+    const auto isWhole = [&source](const Entry &entry) {
+        return entry.image.data == source.data && entry.image.size() == source.size() &&
+               entry.image.type() == source.type();
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = bySource.find(source.data);
+        if (it != bySource.end() && isWhole(*it->second) && !it->second->derived[slot].empty())
+        {
+            ++derivedHits;
+            return it->second->derived[slot];
+        }
+    }
+
+    // 与 imread 一样在锁外转换；并发请求同一表示时可能各转换一次，但只保留先放入的那份
+    cv::Mat converted = convert(source, kind);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++derivedConversions;
+    const auto it = bySource.find(source.data);
+    if (it == bySource.end() || !isWhole(*it->second))
+    {
+        return converted;
+    }
+    Entry &entry = *it->second;
+    if (!entry.derived[slot].empty())
+    {
+        return entry.derived[slot];
+    }
+    entry.derived[slot] = converted;
+    if (converted.data != entry.image.data)
+    {
+        const size_t bytes = matBytes(converted);
+        entry.bytes += bytes;
+        usedBytes += bytes;
+        evictLocked();
+    }
+    return converted;
+}
+
+void ImageCache::setBudgetBytes(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    budgetBytes = bytes;
+    evictLocked();
+}
+
+ImageCache::Stats ImageCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result;
+    result.hits = hits;
+    result.misses = misses;
+    result.derivedHits = derivedHits;
+    result.derivedConversions = derivedConversions;
+    result.entries = entries.size();
+    result.usedBytes = usedBytes;
+    result.budgetBytes = budgetBytes;
+    return result;
+}
+
+void ImageCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    index.clear();
+    bySource.clear();
+    entries.clear();
+    usedBytes = 0;
+}
+
+size_t ImageCache::evictUnreferenced()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t freed = 0;
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (!isUnreferenced(*it))
+        {
+            ++it;
+            continue;
+        }
+        freed += it->bytes;
+        usedBytes -= it->bytes;
+        index.erase(it->key);
+        bySource.erase(it->image.data);
+        it = entries.erase(it);
+    }
+    return freed;
+}
+
+bool ImageCache::isUnreferenced(const Entry &entry)
+{
+    // 条目内部可能多次引用同一缓冲区（1 通道原图的 Gray 就是原图本身），
+    // 引用计数恰好等于条目内的引用数时才说明外部没有人持有
+    std::array<const cv::Mat *, static_cast<size_t>(Derived::Count) + 1> mats{};
+    mats[0] = &entry.image;
+    for (size_t i = 0; i < entry.derived.size(); ++i)
+    {
+        mats[i + 1] = &entry.derived[i];
+    }
+    for (const cv::Mat *mat : mats)
+    {
+        if (!mat->u)
+        {
+            continue;
+        }
+        const int internal = static_cast<int>(std::count_if(mats.begin(), mats.end(), [mat](const cv::Mat *other) {
+            return other->u == mat->u;
+        }));
+        if (mat->u->refcount != internal)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ImageCache::evictLocked()
+{
+    // 从链表尾部（最久未使用）开始淘汰；仍被课程引用的 Mat 会在它们释放后才真正回收内存
+    while (usedBytes > budgetBytes && !entries.empty())
+    {
+        const Entry &victim = entries.back();
+        usedBytes -= victim.bytes;
+        index.erase(victim.key);
+        bySource.erase(victim.image.data);
+        entries.pop_back();
+    }
+}
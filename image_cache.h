@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <opencv2/core.hpp>
+
+class QFileInfo;
+
+// 进程级解码缓存：以（绝对路径、修改时间、文件大小、imread 标志）为键保存解码后的 cv::Mat，
+// 总大小超过内存预算时按 LRU 淘汰。文件被修改后键随之变化，旧结果自然失效。
+// 返回的 Mat 与缓存及其他课程共享像素数据，调用方只能读取，需要修改请先 clone()。
+// 线程安全：解码在锁外进行，可以从后台线程调用。
+//
+// 每个条目还挂着由解码结果派生的表示（灰度/YCrCb/HSV），第一次请求时转换一次，
+// 之后所有课程共享同一份；条目被淘汰或文件变化（键变化）时随原图一起失效。
+class ImageCache
+{
+public:
+    enum class Derived
+    {
+        Gray,
+        YCrCb,
+        HSV,
+        Count
+    };
+
+    struct Stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t derivedHits = 0;
+        std::uint64_t derivedConversions = 0;
+        size_t entries = 0;
+        size_t usedBytes = 0;
+        size_t budgetBytes = 0;
+    };
+
+    static ImageCache &instance();
+
+    cv::Mat imread(const QString &path, int flags);
+    // 只查缓存不解码：未命中（或文件已变化）时返回空 Mat
+    cv::Mat lookup(const QString &path, int flags);
+    // source 须是本缓存返回的 Mat（按像素缓冲区识别，ROI 不算）；否则照常转换但不缓存。
+    // 返回值只读；1 通道原图的 Gray 就是原图本身。
+    cv::Mat derived(const cv::Mat &source, Derived kind);
+
+    void setBudgetBytes(size_t bytes);
+    Stats stats() const;
+    void clear();
+    // 只淘汰已没有课程引用的条目（原图和各派生表示都只被缓存自己持有），返回释放的字节数。
+    // clear() 会连仍在使用的图像一起丢掉：内存并不会释放，下次读取同一文件反而解码出第二份
+    size_t evictUnreferenced();
+
+private:
+    struct Key
+    {
+        std::string path;
+        qint64 modifiedMs = 0;
+        qint64 fileSize = 0;
+        int flags = 0;
+
+        bool operator==(const Key &other) const
+        {
+            return path == other.path && modifiedMs == other.modifiedMs && fileSize == other.fileSize &&
+                   flags == other.flags;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        cv::Mat image;
+        std::array<cv::Mat, static_cast<size_t>(Derived::Count)> derived;
+        size_t bytes = 0; // 含派生表示
+    };
+
+    ImageCache() = default;
+
+    static Key makeKey(const QFileInfo &info, int flags);
+
+    void evictLocked();
+    static bool isUnreferenced(const Entry &entry);
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries; // 头部是最近使用的
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    // 原图像素地址 → 条目，供 derived() 从 Mat 反查
+    std::unordered_map<const uchar *, std::list<Entry>::iterator> bySource;
+    size_t budgetBytes = size_t(512) * 1024 * 1024;
+    size_t usedBytes = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t derivedHits = 0;
+    std::uint64_t derivedConversions = 0;
+};
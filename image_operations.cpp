@@ -0,0 +1,149 @@
+#include "image_operations.h"
+
+#include <algorithm>
+
+#include <opencv2/imgproc.hpp>
+
+#include "color_adjust.h"
+#include "fast_morphology.h"
+#include "image_cache.h"
+#include "point_op_pipeline.h"
+#include "trace.h"
+
+namespace
+{
+double param(const OperationParams &params, const char *key, double fallback)
+{
+    const auto it = params.find(key);
+    return it != params.end() ? it->second : fallback;
+}
+
+cv::Mat toGray(const cv::Mat &bgr)
+{
+    cv::Mat gray;
+    PointOpPipeline().applyToGray(bgr, gray);
+    return gray;
+}
+
+cv::Mat rectElement(const OperationParams &params)
+{
+    const int size = std::max(0, static_cast<int>(param(params, "size", 1)));
+    return cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size * 2 + 1, size * 2 + 1));
+}
+
+std::vector<ImageOperation> buildOperations()
+{
+    std::vector<ImageOperation> operations;
+    operations.push_back({"gray", "灰度化", [](const cv::Mat &bgr, const OperationParams &) {
+                              return toGray(bgr);
+                          }});
+    operations.push_back({"gamma", "灰度 + gamma 变换（gamma=0.6）", [](const cv::Mat &bgr, const OperationParams &params) {
+                              cv::Mat out;
+                              PointOpPipeline().gamma(param(params, "gamma", 0.6)).applyToGray(bgr, out);
+                              return out;
+                          }});
+    operations.push_back({"histogram", "Y 通道直方图均衡化", [](const cv::Mat &bgr, const OperationParams &) {
+                              return equalizeLuminance(bgr);
+                          }});
+    operations.push_back({"truncate", "灰度 + 阈值截断（threshold=120）", [](const cv::Mat &bgr, const OperationParams &params) {
+                              cv::Mat out;
+                              PointOpPipeline().truncate(param(params, "threshold", 120)).applyToGray(bgr, out);
+                              return out;
+                          }});
+    operations.push_back({"color",
+                          "饱和度/色相/通道增益（saturation=40 hue=0 red=1.2 green=1.0 blue=0.8）",
+                          [](const cv::Mat &bgr, const OperationParams &params) {
+                              ColorAdjustParams adjust;
+                              adjust.saturationOffset = param(params, "saturation", adjust.saturationOffset);
+                              adjust.hueShift = param(params, "hue", adjust.hueShift);
+                              adjust.redGain = param(params, "red", adjust.redGain);
+                              adjust.greenGain = param(params, "green", adjust.greenGain);
+                              adjust.blueGain = param(params, "blue", adjust.blueGain);
+                              const ColorAdjustLut lut(adjust);
+                              cv::Mat out;
+                              lut.apply(bgr, out);
+                              return out;
+                          }});
+    operations.push_back({"invert", "反相", [](const cv::Mat &bgr, const OperationParams &) {
+                              cv::Mat out;
+                              PointOpPipeline().invert().apply(bgr, out);
+                              return out;
+                          }});
+    operations.push_back({"threshold", "灰度 + 二值化（threshold=128）", [](const cv::Mat &bgr, const OperationParams &params) {
+                              cv::Mat out;
+                              PointOpPipeline().threshold(param(params, "threshold", 128)).applyToGray(bgr, out);
+                              return out;
+                          }});
+    operations.push_back({"stretch", "灰度 + 最小/最大值对比度拉伸", [](const cv::Mat &bgr, const OperationParams &) {
+                              const cv::Mat gray = toGray(bgr);
+                              double minValue = 0.0;
+                              double maxValue = 0.0;
+                              cv::minMaxLoc(gray, &minValue, &maxValue);
+                              cv::Mat out;
+                              PointOpPipeline().stretch(minValue, maxValue).apply(gray, out);
+                              return out;
+                          }});
+    operations.push_back({"erode", "矩形核腐蚀（size=1，核边长 2*size+1）", [](const cv::Mat &bgr, const OperationParams &params) {
+                              cv::Mat out;
+                              fastErode(bgr, out, rectElement(params));
+                              return out;
+                          }});
+    operations.push_back({"dilate", "矩形核膨胀（size=1，核边长 2*size+1）", [](const cv::Mat &bgr, const OperationParams &params) {
+                              cv::Mat out;
+                              fastDilate(bgr, out, rectElement(params));
+                              return out;
+                          }});
+    operations.push_back({"boundary", "灰度 + 腐蚀边界（size=1）", [](const cv::Mat &bgr, const OperationParams &params) {
+                              cv::Mat out;
+                              morphGradient(toGray(bgr), out, rectElement(params), MorphGradient::Internal);
+                              return out;
+                          }});
+    return operations;
+}
+} // namespace
+
+const std::vector<ImageOperation> &imageOperations()
+{
+    static const std::vector<ImageOperation> operations = buildOperations();
+    return operations;
+}
+
+const ImageOperation *findImageOperation(const std::string &name)
+{
+    for (const ImageOperation &operation : imageOperations())
+    {
+        if (operation.name == name)
+        {
+            return &operation;
+        }
+    }
+    return nullptr;
+}
+
+cv::Mat equalizeLuminance(const cv::Mat &bgr)
+{
+    // 课程里 bgr 来自 ImageCache，YCrCb 直接复用共享的派生表示；批处理中不在缓存里，照常转换
+    const cv::Mat ycrcb = ImageCache::instance().derived(bgr, ImageCache::Derived::YCrCb);
+
+    std::vector<cv::Mat> channels;
+    {
+        TRACE_SCOPE("split");
+        cv::split(ycrcb, channels);
+    }
+    {
+        TRACE_SCOPE("equalizeHist");
+        cv::equalizeHist(channels[0], channels[0]);
+    }
+    cv::Mat merged;
+    {
+        TRACE_SCOPE("merge");
+        cv::merge(channels, merged);
+    }
+
+    cv::Mat equalized;
+    {
+        TRACE_SCOPE("cvtColor");
+        cv::cvtColor(merged, equalized, cv::COLOR_YCrCb2BGR);
+    }
+    return equalized;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// 课程里的图像操作，按名字登记，供命令行批处理等无界面场景调用
+using OperationParams = std::map<std::string, double>;
+
+struct ImageOperation
+{
+    std::string name;
+    std::string description; // 含参数及默认值
+    // 输入为 IMREAD_COLOR 读取的 8 位 BGR 图像；可在任意线程并发调用
+    std::function<cv::Mat(const cv::Mat &bgr, const OperationParams &params)> apply;
+};
+
+const std::vector<ImageOperation> &imageOperations();
+// 找不到时返回 nullptr
+const ImageOperation *findImageOperation(const std::string &name);
+
+// 只在 Y 通道做直方图均衡化，保持色彩（点运算-直方图课程）
+cv::Mat equalizeLuminance(const cv::Mat &bgr);
@@ -0,0 +1,500 @@
+#include "image_view.h"
+
+#include <QCoreApplication>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QPointer>
+#include <QResizeEvent>
+#include <QThreadPool>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "mat_to_qimage.h"
+#include "memory_accounting.h"
+#include "trace.h"
+
+namespace
+{
+constexpr int kTileSize = 256;
+// 瓦片缓存上限（QCache 的 cost 以 KiB 计）
+constexpr int kTileCacheKiB = 64 * 1024;
+constexpr double kMaxZoom = 32.0;
+// 挂起时保存的预览长边上限，放大查看细节时也不保存整幅全分辨率
+constexpr int kSuspendMaxSide = 2048;
+constexpr int kSuspendJpegQuality = 90;
+// 不超过这个像素数的一级直接在界面线程缩小（约 1 ms），更大的交给线程池
+constexpr size_t kSyncResizePixels = 1 << 20;
+
+quint64 tileKey(int level, int tileX, int tileY)
+{
+    return (static_cast<quint64>(level) << 48) | (static_cast<quint64>(tileY) << 24) | static_cast<quint64>(tileX);
+}
+
+// 逐级减半，INTER_AREA 相当于 2x2 取平均，缩小时不会产生摩尔纹
+cv::Mat halve(const cv::Mat &previous)
+{
+    TRACE_SCOPE("pyramid resize");
+    cv::Mat next;
+    cv::resize(previous, next, cv::Size((previous.cols + 1) / 2, (previous.rows + 1) / 2), 0, 0, cv::INTER_AREA);
+    return next;
+}
+
+// 共享方式包装 ROI，再一次性转换成绘制最快的 32 位格式
+QImage convertTile(const cv::Mat &source, int tileX, int tileY)
+{
+    const cv::Rect rect(tileX * kTileSize,
+                        tileY * kTileSize,
+                        std::min(kTileSize, source.cols - tileX * kTileSize),
+                        std::min(kTileSize, source.rows - tileY * kTileSize));
+    if (rect.width <= 0 || rect.height <= 0)
+    {
+        return QImage();
+    }
+
+    TRACE_SCOPE("tile convert");
+    const QImage wrapped = matToQImage(source(rect), MatToQImageMode::Share);
+    if (wrapped.isNull())
+    {
+        return QImage();
+    }
+    const QImage::Format target = wrapped.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                            : QImage::Format_RGB32;
+    return wrapped.convertToFormat(target);
+}
+} // namespace
+
+ImageView::ImageView(QWidget *parent)
+    : QWidget(parent)
+{
+    tileCache.setMaxCost(kTileCacheKiB);
+    setMinimumSize(200, 150);
+    setMouseTracking(false);
+    setFocusPolicy(Qt::WheelFocus);
+}
+
+void ImageView::setImage(const cv::Mat &image, const cv::Size &size)
+{
+    const cv::Size previousLogical = logicalSize;
+
+    pyramid.clear();
+    ++pyramidGeneration;
+    pyramidBuilding = false;
+    wantedLevel = 0;
+    tileCache.clear();
+    suspendedEncoded.clear();
+    suspendedRaw.release();
+    if (image.empty())
+    {
+        logicalSize = cv::Size();
+        shownLevel.release();
+        update();
+        return;
+    }
+
+    pyramid.push_back(image);
+    logicalSize = size.area() > 0 ? size : image.size();
+    // 原图尺寸相同（预览换成全分辨率、参数变化后的新结果）时，新金字塔生成好之前继续画旧的那一级
+    if (logicalSize != previousLogical)
+    {
+        shownLevel.release();
+    }
+
+    // 原图尺寸没变（例如预览换成全分辨率、参数变化后的新结果）时保留用户的缩放和平移
+    if (fitMode || logicalSize != previousLogical)
+    {
+        fitToView();
+        return;
+    }
+    update();
+}
+
+void ImageView::clear()
+{
+    setImage(cv::Mat());
+}
+
+void ImageView::setCaption(const QString &text)
+{
+    caption = text;
+    update();
+}
+
+void ImageView::fitToView()
+{
+    fitMode = true;
+    if (logicalSize.area() > 0)
+    {
+        zoom = fitZoom();
+        origin = QPointF((width() - logicalSize.width * zoom) / 2.0, (height() - logicalSize.height * zoom) / 2.0);
+    }
+    update();
+}
+
+void ImageView::suspend()
+{
+    if (pyramid.empty())
+    {
+        return;
+    }
+
+    TRACE_SCOPE("view suspend");
+    int level = levelForZoom();
+    while (std::max(pyramidLevel(level).cols, pyramidLevel(level).rows) > kSuspendMaxSide)
+    {
+        ++level;
+    }
+    const cv::Mat preview = pyramidLevel(level);
+
+    // 只是恢复时的占位画面，3 通道用 JPEG 足够；灰度、带 Alpha 和 16 位用 PNG 保证不走样
+    bool encoded = false;
+    if (preview.depth() == CV_8U && preview.channels() == 3)
+    {
+        encoded = cv::imencode(".jpg", preview, suspendedEncoded, {cv::IMWRITE_JPEG_QUALITY, kSuspendJpegQuality});
+    }
+    else if (preview.depth() == CV_8U || preview.depth() == CV_16U)
+    {
+        encoded = cv::imencode(".png", preview, suspendedEncoded);
+    }
+    if (!encoded)
+    {
+        suspendedEncoded.clear();
+        suspendedRaw = preview;
+    }
+
+    pyramid.clear();
+    shownLevel.release();
+    ++pyramidGeneration;
+    pyramidBuilding = false;
+    wantedLevel = 0;
+    tileCache.clear();
+}
+
+void ImageView::resume()
+{
+    if (!isSuspended())
+    {
+        return;
+    }
+
+    TRACE_SCOPE("view resume");
+    cv::Mat preview;
+    {
+        memory_accounting::Scope tag("view pyramid");
+        preview = suspendedRaw.empty() ? cv::imdecode(suspendedEncoded, cv::IMREAD_UNCHANGED) : suspendedRaw;
+    }
+    // 原图尺寸没变，setImage 会保留挂起前的缩放和平移
+    setImage(preview, logicalSize);
+}
+
+bool ImageView::isSuspended() const
+{
+    return !suspendedEncoded.empty() || !suspendedRaw.empty();
+}
+
+cv::Size ImageView::logicalImageSize() const
+{
+    return logicalSize;
+}
+
+double ImageView::fitZoom() const
+{
+    if (logicalSize.area() <= 0 || width() <= 0 || height() <= 0)
+    {
+        return 1.0;
+    }
+    return std::min(static_cast<double>(width()) / logicalSize.width,
+                    static_cast<double>(height()) / logicalSize.height);
+}
+
+const cv::Mat &ImageView::pyramidLevel(int level)
+{
+    // 在界面线程同步生成，只用于 suspend 和小图
+    while (static_cast<int>(pyramid.size()) <= level)
+    {
+        memory_accounting::Scope tag("view pyramid");
+        pyramid.push_back(halve(pyramid.back()));
+    }
+    return pyramid[static_cast<size_t>(level)];
+}
+
+bool ImageView::ensureLevel(int level)
+{
+    // 后台正在追加时不在这里追加，否则后台结果的位置对不上
+    while (static_cast<int>(pyramid.size()) <= level && !pyramidBuilding && pyramid.back().total() <= kSyncResizePixels)
+    {
+        pyramidLevel(static_cast<int>(pyramid.size()));
+    }
+    if (static_cast<int>(pyramid.size()) > level)
+    {
+        return true;
+    }
+    buildLevelsAsync(level);
+    return false;
+}
+
+void ImageView::buildLevelsAsync(int level)
+{
+    wantedLevel = std::max(wantedLevel, level);
+    if (pyramidBuilding)
+    {
+        return;
+    }
+    pyramidBuilding = true;
+
+    const QPointer<ImageView> view = this;
+    const quint64 generation = pyramidGeneration;
+    const size_t first = pyramid.size();
+    const int count = wantedLevel - static_cast<int>(first) + 1;
+    const cv::Mat base = pyramid.back();
+    const int lesson = memory_accounting::currentLesson();
+    QThreadPool::globalInstance()->start([view, generation, first, count, base, lesson]() {
+        std::vector<cv::Mat> levels;
+        {
+            memory_accounting::Scope tag(lesson, "view pyramid");
+            cv::Mat previous = base;
+            for (int i = 0; i < count; ++i)
+            {
+                previous = halve(previous);
+                levels.push_back(previous);
+            }
+        }
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [view, generation, first, levels]() {
+            // 期间换了图像或挂起了页面时结果作废
+            if (!view || view->pyramidGeneration != generation)
+            {
+                return;
+            }
+            view->pyramidBuilding = false;
+            if (view->pyramid.size() == first)
+            {
+                view->pyramid.insert(view->pyramid.end(), levels.begin(), levels.end());
+            }
+            // 生成期间又缩放到更小的级别时，重绘会接着请求
+            view->update();
+        }, Qt::QueuedConnection);
+    });
+}
+
+int ImageView::levelForZoom()
+{
+    // 屏幕像素 / 第 0 级像素；选最高的一级，同时保证该级每个像素至少对应一个屏幕像素
+    const double baseScale = static_cast<double>(pyramid.front().cols) / logicalSize.width;
+    const double screenPerPixel = zoom / baseScale;
+    int level = 0;
+    int cols = pyramid.front().cols;
+    int rows = pyramid.front().rows;
+    while (screenPerPixel * std::pow(2.0, level + 1) <= 1.0 && cols > 1 && rows > 1)
+    {
+        ++level;
+        cols = (cols + 1) / 2;
+        rows = (rows + 1) / 2;
+    }
+    return level;
+}
+
+const QImage *ImageView::tile(int level, int tileX, int tileY)
+{
+    const quint64 key = tileKey(level, tileX, tileY);
+    if (const QImage *cached = tileCache.object(key))
+    {
+        return cached;
+    }
+
+    const QImage image = convertTile(pyramid[static_cast<size_t>(level)], tileX, tileY);
+    if (image.isNull())
+    {
+        return nullptr;
+    }
+    auto *converted = new QImage(image);
+    const int costKiB = std::max<qsizetype>(1, converted->sizeInBytes() / 1024);
+    if (!tileCache.insert(key, converted, costKiB))
+    {
+        return nullptr;
+    }
+    return tileCache.object(key);
+}
+
+void ImageView::paintEvent(QPaintEvent *event)
+{
+    TRACE_SCOPE("ImageView paint");
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Dark));
+
+    if (pyramid.empty())
+    {
+        painter.setPen(palette().color(QPalette::BrightText));
+        painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("尚未加载图像"));
+        return;
+    }
+
+    const QRectF dirty = event->rect();
+    const int level = levelForZoom();
+    if (ensureLevel(level))
+    {
+        shownLevel = pyramid[static_cast<size_t>(level)];
+        drawLevel(painter, shownLevel, level, dirty);
+    }
+    else
+    {
+        // 该级在后台生成：先画上一次显示的那一级（可能属于上一幅同尺寸的图像）。
+        // 它比需要的细一级以上时转换量接近整幅图像，改画已生成的最粗一级；都不合适就只画背景
+        const int neededCols = std::max(1, pyramid.front().cols >> level);
+        const auto cheap = [neededCols](const cv::Mat &candidate) {
+            return !candidate.empty() && candidate.cols <= 2 * neededCols;
+        };
+        if (!cheap(shownLevel))
+        {
+            shownLevel = cheap(pyramid.back()) ? pyramid.back() : cv::Mat();
+        }
+        if (!shownLevel.empty())
+        {
+            // 属于当前金字塔的级别照常走瓦片缓存
+            int cachedLevel = -1;
+            for (size_t i = 0; i < pyramid.size(); ++i)
+            {
+                if (pyramid[i].data == shownLevel.data)
+                {
+                    cachedLevel = static_cast<int>(i);
+                }
+            }
+            drawLevel(painter, shownLevel, cachedLevel, dirty);
+        }
+    }
+
+    if (!caption.isEmpty())
+    {
+        const QString text = QStringLiteral("%1  %2%").arg(caption).arg(zoom * 100.0, 0, 'f', 0);
+        const QRect textRect = painter.fontMetrics().boundingRect(text).adjusted(-6, -3, 6, 3);
+        const QRect box(QPoint(8, 8), textRect.size());
+        painter.fillRect(box, QColor(0, 0, 0, 150));
+        painter.setPen(Qt::white);
+        painter.drawText(box, Qt::AlignCenter, text);
+    }
+}
+
+// level < 0 表示 source 不属于当前金字塔，瓦片现转现画、不进缓存
+void ImageView::drawLevel(QPainter &painter, const cv::Mat &source, int level, const QRectF &dirty)
+{
+    // 该级像素到屏幕像素的缩放
+    const double scaleX = zoom * logicalSize.width / source.cols;
+    const double scaleY = zoom * logicalSize.height / source.rows;
+
+    // 需要重绘的区域换算到该级像素坐标，只遍历落在其中的瓦片
+    const int firstX = std::max(0, static_cast<int>(std::floor((dirty.left() - origin.x()) / scaleX)) / kTileSize);
+    const int firstY = std::max(0, static_cast<int>(std::floor((dirty.top() - origin.y()) / scaleY)) / kTileSize);
+    const int lastX = std::min((source.cols - 1) / kTileSize,
+                               static_cast<int>(std::floor((dirty.right() - origin.x()) / scaleX)) / kTileSize);
+    const int lastY = std::min((source.rows - 1) / kTileSize,
+                               static_cast<int>(std::floor((dirty.bottom() - origin.y()) / scaleY)) / kTileSize);
+
+    // 放大到能看清单个像素时关闭平滑，便于观察像素级效果
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, scaleX < 4.0);
+    for (int tileY = firstY; tileY <= lastY; ++tileY)
+    {
+        for (int tileX = firstX; tileX <= lastX; ++tileX)
+        {
+            QImage uncached;
+            const QImage *image = nullptr;
+            if (level >= 0)
+            {
+                image = tile(level, tileX, tileY);
+            }
+            else
+            {
+                uncached = convertTile(source, tileX, tileY);
+                image = uncached.isNull() ? nullptr : &uncached;
+            }
+            if (!image)
+            {
+                continue;
+            }
+            const QRectF target(origin.x() + tileX * kTileSize * scaleX,
+                                origin.y() + tileY * kTileSize * scaleY,
+                                image->width() * scaleX,
+                                image->height() * scaleY);
+            painter.drawImage(target, *image);
+        }
+    }
+}
+
+void ImageView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    if (fitMode)
+    {
+        fitToView();
+    }
+}
+
+void ImageView::zoomAt(const QPointF &anchor, double factor)
+{
+    if (logicalSize.area() <= 0)
+    {
+        return;
+    }
+
+    const double minZoom = fitZoom() / 4.0;
+    const double newZoom = std::clamp(zoom * factor, minZoom, kMaxZoom);
+    // 保持光标下的原图坐标不动
+    const QPointF imagePoint = (anchor - origin) / zoom;
+    zoom = newZoom;
+    origin = anchor - imagePoint * zoom;
+    fitMode = false;
+    update();
+}
+
+void ImageView::wheelEvent(QWheelEvent *event)
+{
+    const double steps = event->angleDelta().y() / 120.0;
+    if (steps != 0.0)
+    {
+        zoomAt(event->position(), std::pow(1.25, steps));
+    }
+    event->accept();
+}
+
+void ImageView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        dragging = true;
+        lastDragPos = event->position().toPoint();
+        setCursor(Qt::ClosedHandCursor);
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void ImageView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (dragging)
+    {
+        const QPoint pos = event->position().toPoint();
+        origin += QPointF(pos - lastDragPos);
+        lastDragPos = pos;
+        fitMode = false;
+        update();
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void ImageView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && dragging)
+    {
+        dragging = false;
+        unsetCursor();
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void ImageView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    fitToView();
+    QWidget::mouseDoubleClickEvent(event);
+}
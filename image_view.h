@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QPoint>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <QWidget>
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+class QMouseEvent;
+class QPainter;
+class QPaintEvent;
+class QResizeEvent;
+class QWheelEvent;
+
+// 应用内的图像视图，取代 cv::namedWindow + cv::imshow：
+// - 按需构建 mipmap 金字塔（每级长宽减半），绘制时选与当前缩放最接近的一级；
+//   大图的缩小在线程池里进行，生成好之前继续显示上一幅图像（原图尺寸相同时）已显示的那一级；
+// - 只转换、绘制可见的 256x256 瓦片，并缓存转换好的瓦片，重绘开销只与视口大小有关；
+// - 滚轮以光标为中心缩放，左键拖动平移，双击恢复“适应窗口”。
+// 传给 setImage 的 Mat 会被共享引用，之后不要原地修改它（需要更新时重新 setImage）。
+class ImageView : public QWidget
+{
+public:
+    explicit ImageView(QWidget *parent = nullptr);
+
+    // logicalSize 为空时等于 image.size()；传入原图尺寸时，低分辨率的预览图会按原图坐标显示，
+    // 替换成全分辨率后缩放和平移位置保持不变
+    void setImage(const cv::Mat &image, const cv::Size &logicalSize = cv::Size());
+    void clear();
+    // 显示在左上角的标题，例如“原图”“处理结果”
+    void setCaption(const QString &text);
+    void fitToView();
+
+    // 页面挂起时调用：把接近当前显示尺寸的一级编码保存（3 通道 JPEG，其余 PNG），
+    // 释放金字塔和瓦片缓存；缩放和平移位置保留。resume() 解码后立即恢复画面。
+    // 挂起期间调用 setImage 会丢弃保存的预览。
+    void suspend();
+    void resume();
+    bool isSuspended() const;
+
+    cv::Size logicalImageSize() const;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    const cv::Mat &pyramidLevel(int level);
+    bool ensureLevel(int level);
+    void buildLevelsAsync(int level);
+    int levelForZoom();
+    const QImage *tile(int level, int tileX, int tileY);
+    void drawLevel(QPainter &painter, const cv::Mat &source, int level, const QRectF &dirty);
+    double fitZoom() const;
+    void zoomAt(const QPointF &anchor, double factor);
+
+    std::vector<cv::Mat> pyramid; // pyramid[0] 是传入的图像，其余按需生成
+    cv::Mat shownLevel;           // 上一次绘制所用的那一级
+    cv::Mat fallbackLevel;        // 新图像需要的那一级生成好之前，代替它绘制的上一幅图像的一级
+    quint64 pyramidGeneration = 0; // setImage/suspend 时递增，过时的后台结果直接丢弃
+    bool pyramidBuilding = false;
+    int wantedLevel = 0;          // 后台生成期间又需要的最高一级
+    cv::Size logicalSize;
+    QString caption;
+    double zoom = 1.0;   // 屏幕像素 / 原图像素
+    QPointF origin;      // 原图 (0, 0) 在控件中的位置
+    bool fitMode = true; // 为 true 时控件尺寸变化会重新适应
+    bool dragging = false;
+    QPoint lastDragPos;
+    QCache<quint64, QImage> tileCache;
+    std::vector<uchar> suspendedEncoded; // 挂起时保存的编码预览
+    cv::Mat suspendedRaw;                // 无法编码的深度（如 32F）直接保留该级
+};
@@ -0,0 +1,163 @@
+#include "large_pages.h"
+
+#include <opencv2/core.hpp>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+// 旧内核头文件没有页大小编码（linux/mman.h：log2(页大小) << MAP_HUGE_SHIFT）
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
+namespace large_pages
+{
+namespace
+{
+#ifdef __linux__
+void prefaultPages(void *data, size_t bytes)
+{
+    auto *base = static_cast<volatile unsigned char *>(data);
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const int chunks = static_cast<int>(bytes / kHugePageBytes);
+    // 整段按 2 MiB 切块交给 parallel_for_ 的工作线程触碰，页按首次触碰策略落在各自线程所在的节点。
+    // 这只是尽力而为：分块到线程的映射由线程池调度决定，之后处理同一行带的线程未必是触碰它的那个，
+    // 也没有用 mbind/set_mempolicy 固定节点；可靠的收益只是把缺页挪出第一遍处理
+    cv::parallel_for_(cv::Range(0, chunks), [base, page](const cv::Range &range) {
+        for (int chunk = range.start; chunk < range.end; ++chunk)
+        {
+            const size_t begin = static_cast<size_t>(chunk) * kHugePageBytes;
+            for (size_t offset = 0; offset < kHugePageBytes; offset += page)
+            {
+                base[begin + offset] = 0;
+            }
+        }
+    });
+}
+
+void *mapTransparent(size_t bytes)
+{
+    // 多映射 2 MiB 再裁掉首尾，保证起始地址按大页对齐，THP 才能整页映射
+    const size_t padded = bytes + kHugePageBytes;
+    void *raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    const auto address = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t aligned = (address + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+    const size_t head = aligned - address;
+    const size_t tail = padded - head - bytes;
+    if (head > 0)
+    {
+        munmap(raw, head);
+    }
+    if (tail > 0)
+    {
+        munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+    }
+    void *data = reinterpret_cast<void *>(aligned);
+    madvise(data, bytes, MADV_HUGEPAGE);
+    return data;
+}
+#endif
+} // namespace
+
+void *allocate(size_t bytes, bool prefault, Kind *kind)
+{
+    if (kind)
+    {
+        *kind = Kind::None;
+    }
+#ifdef __linux__
+    if (bytes == 0 || bytes % kHugePageBytes != 0)
+    {
+        return nullptr;
+    }
+
+    // 显式要求 2 MiB 大页：不指定时用系统默认大页尺寸，default_hugepagesz=1G 的机器上
+    // 每次映射都会向上取整到 1 GiB，按 bytes 的 munmap 也会失败
+    Kind mapped = Kind::HugeTlb;
+    void *data = mmap(nullptr,
+                      bytes,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB,
+                      -1,
+                      0);
+    if (data == MAP_FAILED)
+    {
+        mapped = Kind::Transparent;
+        data = mapTransparent(bytes);
+        if (!data)
+        {
+            return nullptr;
+        }
+    }
+
+    if (prefault)
+    {
+        prefaultPages(data, bytes);
+    }
+    if (kind)
+    {
+        *kind = mapped;
+    }
+    return data;
+#else
+    (void)bytes;
+    (void)prefault;
+    return nullptr;
+#endif
+}
+
+bool release(void *data, size_t bytes)
+{
+#ifdef __linux__
+    if (data && munmap(data, bytes) != 0)
+    {
+        const int error = errno;
+        std::fprintf(stderr, "large_pages: munmap(%p, %zu) 失败：%s\n", data, bytes, std::strerror(error));
+        return false;
+    }
+    return true;
+#else
+    (void)data;
+    (void)bytes;
+    return true;
+#endif
+}
+
+std::uint64_t minorFaults()
+{
+#ifdef __linux__
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::uint64_t>(usage.ru_minflt);
+#else
+    return 0;
+#endif
+}
+
+std::uint64_t majorFaults()
+{
+#ifdef __linux__
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::uint64_t>(usage.ru_majflt);
+#else
+    return 0;
+#endif
+}
+} // namespace large_pages
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 大块像素内存的页分配（仅 Linux，其余平台 allocate 返回 nullptr，调用方退回普通分配）：
+// 先尝试 MAP_HUGETLB（需要系统预留 hugetlbfs 页），失败再用 2 MiB 对齐的匿名映射 +
+// MADV_HUGEPAGE 交给透明大页。prefault 时用 cv::parallel_for_ 分块交给工作线程逐页写入，
+// 把缺页挪出第一遍处理；NUMA 上页面按首次触碰分散到各线程所在节点，但不保证与之后处理
+// 各行带的线程一致（没有用 mbind 固定），只算尽力而为。
+namespace large_pages
+{
+enum class Kind
+{
+    None,
+    HugeTlb,
+    Transparent
+};
+
+constexpr size_t kHugePageBytes = size_t(2) * 1024 * 1024;
+
+// bytes 须为 kHugePageBytes 的整数倍；失败返回 nullptr
+void *allocate(size_t bytes, bool prefault, Kind *kind = nullptr);
+// munmap 失败（映射泄漏）时向 stderr 报告并返回 false
+bool release(void *data, size_t bytes);
+
+// 本进程累计的缺页次数（minor / major），用于对比开启前后
+std::uint64_t minorFaults();
+std::uint64_t majorFaults();
+} // namespace large_pages
@@ -0,0 +1,22 @@
+#pragma once
+
+// 课程页面的生命周期，由 MainWindow 驱动（课程控件同时继承 QWidget 和本接口，默认实现都是空操作）：
+//
+//   activate    页面切到前台。重新打开 deactivate 时关掉的 HighGUI 窗口、恢复定时器。
+//   deactivate  页面离开前台。停止一切会继续占用 CPU 的东西：定时器、后台任务、HighGUI 窗口，
+//               但保留全分辨率数据，短时间内切回来不需要重新计算。
+//   suspend     页面已不可见一段时间，或内存超出预算。释放全分辨率图像和中间结果，
+//               只留下压缩形式的状态（显示尺寸的编码预览、画布、图像路径和参数）。
+//   resume      重新进入已挂起的页面。先用压缩状态立即恢复画面，再在后台按路径和参数重建全分辨率数据。
+//
+// 调用顺序保证为 deactivate → [suspend → resume] → activate；suspend 只会在 deactivate 之后调用。
+class LessonLifecycle
+{
+public:
+    virtual ~LessonLifecycle() = default;
+
+    virtual void activate() {}
+    virtual void deactivate() {}
+    virtual void suspend() {}
+    virtual void resume() {}
+};
@@ -0,0 +1,46 @@
+#include "lesson_registry.h"
+
+#include <QWidget>
+
+#include "01 生成并保存图片/imwrite_lesson_widget.h"
+#include "02 读取并显示图片/imread_lesson_widget.h"
+#include "03 窗口显示/named_window_lesson_widget.h"
+#include "04 腐蚀与膨胀/morphology_trackbar_lesson_widget.h"
+#include "05 边界提取/erosion_boundary_lesson_widget.h"
+#include "06 点运算-灰度变换/point_gray_transform_lesson_widget.h"
+#include "07 点运算-直方图/point_histogram_lesson_widget.h"
+#include "08 点运算-截断/point_truncation_lesson_widget.h"
+#include "09 点运算-提升饱和度与颜色/point_color_adjust_lesson_widget.h"
+#include "10 点运算-反相/point_invert_lesson_widget.h"
+#include "11 点运算-二值化/point_threshold_lesson_widget.h"
+#include "12 点运算-对比度拉伸/point_contrast_stretch_lesson_widget.h"
+
+namespace
+{
+template <typename LessonWidget>
+LessonDescriptor lesson(const QString &title)
+{
+    return LessonDescriptor{title, [](QWidget *parent) -> QWidget * {
+                                return new LessonWidget(parent);
+                            }};
+}
+} // namespace
+
+const std::vector<LessonDescriptor> &lessonRegistry()
+{
+    static const std::vector<LessonDescriptor> lessons = {
+        lesson<ImwriteLessonWidget>(QStringLiteral("imwrite：生成并保存图片")),
+        lesson<ImreadLessonWidget>(QStringLiteral("imread：读取并显示图片")),
+        lesson<NamedWindowLessonWidget>(QStringLiteral("namedWindow：OpenCV 窗口显示")),
+        lesson<MorphologyTrackbarLessonWidget>(QStringLiteral("Trackbar：腐蚀与膨胀")),
+        lesson<ErosionBoundaryLessonWidget>(QStringLiteral("腐蚀应用：边界提取")),
+        lesson<PointGrayTransformLessonWidget>(QStringLiteral("点运算：灰度变换")),
+        lesson<PointHistogramLessonWidget>(QStringLiteral("点运算：直方图均衡化")),
+        lesson<PointTruncationLessonWidget>(QStringLiteral("点运算：截断")),
+        lesson<PointColorAdjustLessonWidget>(QStringLiteral("点运算：提升饱和度/颜色增强")),
+        lesson<PointInvertLessonWidget>(QStringLiteral("点运算：反相")),
+        lesson<PointThresholdLessonWidget>(QStringLiteral("点运算：二值化")),
+        lesson<PointContrastStretchLessonWidget>(QStringLiteral("点运算：对比度拉伸")),
+    };
+    return lessons;
+}
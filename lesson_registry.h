@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+class QWidget;
+
+// 课程注册表：首页列表按注册顺序展示。
+// create 只在第一次进入该课程时才被调用，启动阶段不会构造任何课程控件，也不会读写文件。
+struct LessonDescriptor
+{
+    QString title;
+    std::function<QWidget *(QWidget *parent)> create;
+};
+
+const std::vector<LessonDescriptor> &lessonRegistry();
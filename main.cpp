@@ -1,9 +1,91 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
 
+#include <cstdio>
+
+#include "batch_runner.h"
 #include "main_window.h"
+#include "mat_pool.h"
+
+namespace
+{
+bool hasBatchFlag(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (qstrcmp(argv[i], "--batch") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 批处理模式只需要 QCoreApplication，可以在没有显示器的机器上运行
+int runBatchMode(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("对目录下的图片批量执行课程操作"));
+    parser.addHelpOption();
+    const QCommandLineOption batchOption(QStringLiteral("batch"), QStringLiteral("无界面批处理模式"));
+    const QCommandLineOption inputOption(QStringLiteral("input"), QStringLiteral("输入目录或通配符"), QStringLiteral("path"));
+    const QCommandLineOption outputOption(QStringLiteral("output"), QStringLiteral("输出目录"), QStringLiteral("dir"));
+    const QCommandLineOption opOption(QStringLiteral("op"), QStringLiteral("操作名，见 --list-ops"), QStringLiteral("name"));
+    const QCommandLineOption paramOption(QStringLiteral("param"), QStringLiteral("操作参数 key=value，可重复"), QStringLiteral("key=value"));
+    const QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("输出格式（扩展名）"), QStringLiteral("ext"), QStringLiteral("png"));
+    const QCommandLineOption jobsOption(QStringLiteral("jobs"), QStringLiteral("处理线程数，默认为 CPU 核数"), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption listOption(QStringLiteral("list-ops"), QStringLiteral("列出可用操作"));
+    parser.addOptions({batchOption, inputOption, outputOption, opOption, paramOption, formatOption, jobsOption, listOption});
+    parser.process(app);
+
+    if (parser.isSet(listOption))
+    {
+        for (const ImageOperation &operation : imageOperations())
+        {
+            std::printf("  %-10s %s\n", operation.name.c_str(), operation.description.c_str());
+        }
+        return 0;
+    }
+    if (!parser.isSet(inputOption) || !parser.isSet(outputOption) || !parser.isSet(opOption))
+    {
+        std::fprintf(stderr, "批处理模式需要 --input、--output 和 --op\n");
+        return 2;
+    }
+
+    BatchOptions options;
+    options.input = parser.value(inputOption);
+    options.outputDir = parser.value(outputOption);
+    options.operation = parser.value(opOption).toStdString();
+    options.format = parser.value(formatOption);
+    options.jobs = parser.value(jobsOption).toInt();
+    for (const QString &param : parser.values(paramOption))
+    {
+        const qsizetype separator = param.indexOf(QLatin1Char('='));
+        bool ok = false;
+        const double value = separator > 0 ? param.mid(separator + 1).toDouble(&ok) : 0.0;
+        if (!ok)
+        {
+            std::fprintf(stderr, "参数格式应为 key=数值：%s\n", qPrintable(param));
+            return 2;
+        }
+        options.params[param.left(separator).toStdString()] = value;
+    }
+    return runBatch(options);
+}
+} // namespace
 
 int main(int argc, char *argv[])
 {
+    MatPool::install();
+
+    if (hasBatchFlag(argc, argv))
+    {
+        return runBatchMode(argc, argv);
+    }
+
     QApplication app(argc, argv);
 
     MainWindow window;
@@ -1,48 +1,45 @@
 #include "main_window.h"
 
+#include <QApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QDockWidget>
+#include <QEvent>
+#include <QKeySequence>
 #include <QLabel>
 #include <QListWidget>
 #include <QListWidgetItem>
+#include <QPointer>
 #include <QPushButton>
+#include <QShortcut>
 #include <QStackedWidget>
+#include <QTimer>
 #include <QVBoxLayout>
 
-#include "01 生成并保存图片/imwrite_lesson_widget.h"
-#include "02 读取并显示图片/imread_lesson_widget.h"
-#include "03 窗口显示/named_window_lesson_widget.h"
-#include "04 腐蚀与膨胀/morphology_trackbar_lesson_widget.h"
-#include "05 边界提取/erosion_boundary_lesson_widget.h"
-#include "06 点运算-灰度变换/point_gray_transform_lesson_widget.h"
-#include "07 点运算-直方图/point_histogram_lesson_widget.h"
-#include "08 点运算-截断/point_truncation_lesson_widget.h"
-#include "09 点运算-提升饱和度与颜色/point_color_adjust_lesson_widget.h"
-#include "10 点运算-反相/point_invert_lesson_widget.h"
-#include "11 点运算-二值化/point_threshold_lesson_widget.h"
-#include "12 点运算-对比度拉伸/point_contrast_stretch_lesson_widget.h"
+#include <algorithm>
+#include <cstdlib>
+
+#include "image_cache.h"
+#include "lesson_lifecycle.h"
+#include "lesson_registry.h"
+#include "mat_pool.h"
+#include "memory_accounting.h"
+#include "memory_panel.h"
+#include "trace.h"
+#include "trace_overlay.h"
+
+namespace
+{
+// 离开课程多久之后挂起
+constexpr int kSuspendDelayMs = 30000;
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
 {
     stack = new QStackedWidget();
 
-    enum PageIndex
-    {
-        HomePageIndex = 0,
-        ImwritePageIndex = 1,
-        ImreadPageIndex = 2,
-        NamedWindowPageIndex = 3,
-        MorphologyPageIndex = 4,
-        ErosionBoundaryPageIndex = 5,
-        PointGrayTransformPageIndex = 6,
-        PointHistogramPageIndex = 7,
-        PointTruncationPageIndex = 8,
-        PointColorAdjustPageIndex = 9,
-        PointInvertPageIndex = 10,
-        PointThresholdPageIndex = 11,
-        PointContrastStretchPageIndex = 12
-    };
-
-    auto *homePage = new QWidget();
+    homePage = new QWidget();
     auto *homeLayout = new QVBoxLayout(homePage);
 
     auto *homeTitle = new QLabel(QStringLiteral("OpenCV 学习项目"), homePage);
@@ -50,209 +47,335 @@ MainWindow::MainWindow(QWidget *parent)
 
     lessonList = new QListWidget(homePage);
 
-    auto *imwriteItem = new QListWidgetItem(QStringLiteral("imwrite：生成并保存图片"));
-    imwriteItem->setData(Qt::UserRole, ImwritePageIndex);
-    lessonList->addItem(imwriteItem);
-
-    auto *imreadItem = new QListWidgetItem(QStringLiteral("imread：读取并显示图片"));
-    imreadItem->setData(Qt::UserRole, ImreadPageIndex);
-    lessonList->addItem(imreadItem);
-
-    auto *namedWindowItem = new QListWidgetItem(QStringLiteral("namedWindow：OpenCV 窗口显示"));
-    namedWindowItem->setData(Qt::UserRole, NamedWindowPageIndex);
-    lessonList->addItem(namedWindowItem);
-
-    auto *morphologyItem = new QListWidgetItem(QStringLiteral("Trackbar：腐蚀与膨胀"));
-    morphologyItem->setData(Qt::UserRole, MorphologyPageIndex);
-    lessonList->addItem(morphologyItem);
-
-    auto *erosionBoundaryItem = new QListWidgetItem(QStringLiteral("腐蚀应用：边界提取"));
-    erosionBoundaryItem->setData(Qt::UserRole, ErosionBoundaryPageIndex);
-    lessonList->addItem(erosionBoundaryItem);
-
-    auto *pointGrayItem = new QListWidgetItem(QStringLiteral("点运算：灰度变换"));
-    pointGrayItem->setData(Qt::UserRole, PointGrayTransformPageIndex);
-    lessonList->addItem(pointGrayItem);
-
-    auto *pointHistogramItem = new QListWidgetItem(QStringLiteral("点运算：直方图均衡化"));
-    pointHistogramItem->setData(Qt::UserRole, PointHistogramPageIndex);
-    lessonList->addItem(pointHistogramItem);
-
-    auto *pointTruncationItem = new QListWidgetItem(QStringLiteral("点运算：截断"));
-    pointTruncationItem->setData(Qt::UserRole, PointTruncationPageIndex);
-    lessonList->addItem(pointTruncationItem);
-
-    auto *pointColorItem = new QListWidgetItem(QStringLiteral("点运算：提升饱和度/颜色增强"));
-    pointColorItem->setData(Qt::UserRole, PointColorAdjustPageIndex);
-    lessonList->addItem(pointColorItem);
-
-    auto *pointInvertItem = new QListWidgetItem(QStringLiteral("点运算：反相"));
-    pointInvertItem->setData(Qt::UserRole, PointInvertPageIndex);
-    lessonList->addItem(pointInvertItem);
-
-    auto *pointThresholdItem = new QListWidgetItem(QStringLiteral("点运算：二值化"));
-    pointThresholdItem->setData(Qt::UserRole, PointThresholdPageIndex);
-    lessonList->addItem(pointThresholdItem);
-
-    auto *pointContrastItem = new QListWidgetItem(QStringLiteral("点运算：对比度拉伸"));
-    pointContrastItem->setData(Qt::UserRole, PointContrastStretchPageIndex);
-    lessonList->addItem(pointContrastItem);
+    // 首页只登记标题，课程页面在第一次点击时才创建
+    const std::vector<LessonDescriptor> &lessons = lessonRegistry();
+    lessonPages.assign(lessons.size(), nullptr);
+    lessonLifecycles.assign(lessons.size(), nullptr);
+    lessonSuspended.assign(lessons.size(), false);
+    for (size_t i = 0; i < lessons.size(); ++i)
+    {
+        auto *item = new QListWidgetItem(lessons[i].title);
+        item->setData(Qt::UserRole, static_cast<int>(i));
+        lessonList->addItem(item);
+    }
 
     homeLayout->addWidget(homeTitle);
     homeLayout->addWidget(lessonList, 1);
 
-    auto *imwritePage = new QWidget();
-    auto *imwriteLayout = new QVBoxLayout(imwritePage);
-    imwriteBackButton = new QPushButton(QStringLiteral("返回首页"), imwritePage);
-    auto *imwriteLesson = new ImwriteLessonWidget(imwritePage);
-
-    imwriteLayout->addWidget(imwriteBackButton, 0, Qt::AlignLeft);
-    imwriteLayout->addWidget(imwriteLesson, 1);
-
-    auto *imreadPage = new QWidget();
-    auto *imreadLayout = new QVBoxLayout(imreadPage);
-    imreadBackButton = new QPushButton(QStringLiteral("返回首页"), imreadPage);
-    auto *imreadLesson = new ImreadLessonWidget(imreadPage);
-
-    imreadLayout->addWidget(imreadBackButton, 0, Qt::AlignLeft);
-    imreadLayout->addWidget(imreadLesson, 1);
-
-    auto *namedWindowPage = new QWidget();
-    auto *namedWindowLayout = new QVBoxLayout(namedWindowPage);
-    auto *namedWindowBackButton = new QPushButton(QStringLiteral("返回首页"), namedWindowPage);
-    auto *namedWindowLesson = new NamedWindowLessonWidget(namedWindowPage);
-
-    namedWindowLayout->addWidget(namedWindowBackButton, 0, Qt::AlignLeft);
-    namedWindowLayout->addWidget(namedWindowLesson, 1);
+    stack->addWidget(homePage);
 
-    auto *morphologyPage = new QWidget();
-    auto *morphologyLayout = new QVBoxLayout(morphologyPage);
-    auto *morphologyBackButton = new QPushButton(QStringLiteral("返回首页"), morphologyPage);
-    auto *morphologyLesson = new MorphologyTrackbarLessonWidget(morphologyPage);
+    QObject::connect(lessonList, &QListWidget::itemClicked, stack, [this](QListWidgetItem *item) {
+        showLesson(item->data(Qt::UserRole).toInt());
+    });
 
-    morphologyLayout->addWidget(morphologyBackButton, 0, Qt::AlignLeft);
-    morphologyLayout->addWidget(morphologyLesson, 1);
+    suspendTimer = new QTimer(this);
+    suspendTimer->setSingleShot(true);
+    suspendTimer->setInterval(kSuspendDelayMs);
+    QObject::connect(suspendTimer, &QTimer::timeout, this, [this]() {
+        suspendHiddenLessons();
+    });
 
-    auto *erosionBoundaryPage = new QWidget();
-    auto *erosionBoundaryLayout = new QVBoxLayout(erosionBoundaryPage);
-    auto *erosionBoundaryBackButton = new QPushButton(QStringLiteral("返回首页"), erosionBoundaryPage);
-    auto *erosionBoundaryLesson = new ErosionBoundaryLessonWidget(erosionBoundaryPage);
+    setWindowTitle(QStringLiteral("Qt + OpenCV 学习项目"));
+    setCentralWidget(stack);
+    resize(800, 600);
 
-    erosionBoundaryLayout->addWidget(erosionBoundaryBackButton, 0, Qt::AlignLeft);
-    erosionBoundaryLayout->addWidget(erosionBoundaryLesson, 1);
+    // 性能跟踪：Ctrl+Shift+T 开关（环境变量 OPENCV_LESSONS_TRACE=1 启动即开启），Ctrl+Shift+S 导出
+    traceOverlay = new TraceOverlay(this);
+    auto *toggleTrace = new QShortcut(QKeySequence(QStringLiteral("Ctrl+Shift+T")), this);
+    QObject::connect(toggleTrace, &QShortcut::activated, this, [this]() {
+        setTracing(!trace::isEnabled());
+    });
+    auto *saveTrace = new QShortcut(QKeySequence(QStringLiteral("Ctrl+Shift+S")), this);
+    QObject::connect(saveTrace, &QShortcut::activated, this, [this]() {
+        exportTrace();
+    });
+    qApp->installEventFilter(this);
+    setTracing(trace::isEnabled());
+
+    // 内存面板：Ctrl+Shift+M 开关；预算默认 2 GiB，可用 OPENCV_LESSONS_MEMORY_BUDGET_MB 或面板修改
+    memoryPanel = new MemoryPanel();
+    memoryDock = new QDockWidget(QStringLiteral("内存"), this);
+    memoryDock->setWidget(memoryPanel);
+    addDockWidget(Qt::RightDockWidgetArea, memoryDock);
+    memoryDock->hide();
+    memoryPanel->setBudgetHandler([this](int budgetMiB) {
+        setMemoryBudget(budgetMiB);
+    });
+    memoryPanel->setReclaimHandler([this]() {
+        reclaimMemory(false);
+    });
+    auto *toggleMemory = new QShortcut(QKeySequence(QStringLiteral("Ctrl+Shift+M")), this);
+    QObject::connect(toggleMemory, &QShortcut::activated, this, [this]() {
+        memoryDock->setVisible(!memoryDock->isVisible());
+    });
 
-    auto *pointGrayPage = new QWidget();
-    auto *pointGrayLayout = new QVBoxLayout(pointGrayPage);
-    auto *pointGrayBackButton = new QPushButton(QStringLiteral("返回首页"), pointGrayPage);
-    auto *pointGrayLesson = new PointGrayTransformLessonWidget(pointGrayPage);
+    const char *budgetEnv = std::getenv("OPENCV_LESSONS_MEMORY_BUDGET_MB");
+    const int budgetMiB = budgetEnv ? std::max(0, std::atoi(budgetEnv)) : 2048;
+    memoryPanel->setBudgetMiB(budgetMiB);
+    setMemoryBudget(budgetMiB);
+    // 退出事件循环时就摘掉超限回调，窗口可能在 exec() 返回之后才析构
+    connect(qApp, &QCoreApplication::aboutToQuit, this, []() {
+        memory_accounting::setBudget(0, nullptr);
+    });
+}
 
-    pointGrayLayout->addWidget(pointGrayBackButton, 0, Qt::AlignLeft);
-    pointGrayLayout->addWidget(pointGrayLesson, 1);
+MainWindow::~MainWindow()
+{
+    // 先摘掉超限回调，再趁成员都还有效时销毁课程页面：课程析构会取消并等待各自的处理线程，
+    // 之后不会再有工作线程分配内存、触发回调
+    memory_accounting::setBudget(0, nullptr);
+    for (QWidget *&page : lessonPages)
+    {
+        if (page)
+        {
+            stack->removeWidget(page);
+            delete page;
+            page = nullptr;
+        }
+    }
+    std::fill(lessonLifecycles.begin(), lessonLifecycles.end(), nullptr);
+}
 
-    auto *pointHistogramPage = new QWidget();
-    auto *pointHistogramLayout = new QVBoxLayout(pointHistogramPage);
-    auto *pointHistogramBackButton = new QPushButton(QStringLiteral("返回首页"), pointHistogramPage);
-    auto *pointHistogramLesson = new PointHistogramLessonWidget(pointHistogramPage);
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (trace::isEnabled())
+    {
+        switch (event->type())
+        {
+        case QEvent::MouseButtonPress:
+        case QEvent::KeyPress:
+        case QEvent::Wheel:
+            // 同一次输入会沿父子链分发多次，只在第一次（发给窗口本身）时标记
+            if (watched->isWindowType())
+            {
+                trace::markInteraction();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
 
-    pointHistogramLayout->addWidget(pointHistogramBackButton, 0, Qt::AlignLeft);
-    pointHistogramLayout->addWidget(pointHistogramLesson, 1);
+void MainWindow::setTracing(bool enabled)
+{
+    trace::setEnabled(enabled);
+    if (enabled)
+    {
+        trace::clear();
+    }
+    traceOverlay->setActive(enabled);
+}
 
-    auto *pointTruncationPage = new QWidget();
-    auto *pointTruncationLayout = new QVBoxLayout(pointTruncationPage);
-    auto *pointTruncationBackButton = new QPushButton(QStringLiteral("返回首页"), pointTruncationPage);
-    auto *pointTruncationLesson = new PointTruncationLessonWidget(pointTruncationPage);
+void MainWindow::exportTrace()
+{
+    const QString path = QDir::current().filePath(
+        QStringLiteral("trace_%1.json").arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd_HHmmss"))));
+    if (trace::writeChromeTrace(path.toStdString()))
+    {
+        traceOverlay->setFooter(QStringLiteral("已导出：%1").arg(path));
+    }
+    else
+    {
+        traceOverlay->setFooter(QStringLiteral("导出失败：%1").arg(path));
+    }
+}
 
-    pointTruncationLayout->addWidget(pointTruncationBackButton, 0, Qt::AlignLeft);
-    pointTruncationLayout->addWidget(pointTruncationLesson, 1);
+void MainWindow::showLesson(int lessonIndex)
+{
+    if (lessonIndex < 0 || lessonIndex >= static_cast<int>(lessonPages.size()))
+    {
+        return;
+    }
 
-    auto *pointColorPage = new QWidget();
-    auto *pointColorLayout = new QVBoxLayout(pointColorPage);
-    auto *pointColorBackButton = new QPushButton(QStringLiteral("返回首页"), pointColorPage);
-    auto *pointColorLesson = new PointColorAdjustLessonWidget(pointColorPage);
+    if (lessonIndex == activeLesson)
+    {
+        return;
+    }
+    leaveLesson();
+
+    // 之后 GUI 线程里的 Mat 分配（以及从这里提交的后台任务）都记到该课程
+    memory_accounting::setCurrentLesson(lessonIndex);
+    recentLessons.erase(std::remove(recentLessons.begin(), recentLessons.end(), lessonIndex), recentLessons.end());
+    recentLessons.insert(recentLessons.begin(), lessonIndex);
+    memory_accounting::rearm();
+
+    QWidget *&page = lessonPages[static_cast<size_t>(lessonIndex)];
+    if (!page)
+    {
+        page = createLessonPage(lessonIndex);
+        stack->addWidget(page);
+    }
+    stack->setCurrentWidget(page);
 
-    pointColorLayout->addWidget(pointColorBackButton, 0, Qt::AlignLeft);
-    pointColorLayout->addWidget(pointColorLesson, 1);
+    activeLesson = lessonIndex;
+    if (LessonLifecycle *lifecycle = lessonLifecycles[static_cast<size_t>(lessonIndex)])
+    {
+        if (lessonSuspended[static_cast<size_t>(lessonIndex)])
+        {
+            TRACE_SCOPE("lesson resume");
+            lifecycle->resume();
+            lessonSuspended[static_cast<size_t>(lessonIndex)] = false;
+        }
+        lifecycle->activate();
+    }
+}
 
-    auto *pointInvertPage = new QWidget();
-    auto *pointInvertLayout = new QVBoxLayout(pointInvertPage);
-    auto *pointInvertBackButton = new QPushButton(QStringLiteral("返回首页"), pointInvertPage);
-    auto *pointInvertLesson = new PointInvertLessonWidget(pointInvertPage);
+QWidget *MainWindow::createLessonPage(int lessonIndex)
+{
+    const LessonDescriptor &descriptor = lessonRegistry()[static_cast<size_t>(lessonIndex)];
+
+    auto *page = new QWidget();
+    auto *layout = new QVBoxLayout(page);
+    auto *backButton = new QPushButton(QStringLiteral("返回首页"), page);
+    QWidget *lessonWidget = descriptor.create(page);
+    lessonLifecycles[static_cast<size_t>(lessonIndex)] = dynamic_cast<LessonLifecycle *>(lessonWidget);
+    lessonSuspended[static_cast<size_t>(lessonIndex)] = false;
+
+    layout->addWidget(backButton, 0, Qt::AlignLeft);
+    layout->addWidget(lessonWidget, 1);
+
+    QObject::connect(backButton, &QPushButton::clicked, stack, [this]() {
+        leaveLesson();
+        memory_accounting::setCurrentLesson(memory_accounting::kSharedLesson);
+        stack->setCurrentWidget(homePage);
+    });
 
-    pointInvertLayout->addWidget(pointInvertBackButton, 0, Qt::AlignLeft);
-    pointInvertLayout->addWidget(pointInvertLesson, 1);
+    return page;
+}
 
-    auto *pointThresholdPage = new QWidget();
-    auto *pointThresholdLayout = new QVBoxLayout(pointThresholdPage);
-    auto *pointThresholdBackButton = new QPushButton(QStringLiteral("返回首页"), pointThresholdPage);
-    auto *pointThresholdLesson = new PointThresholdLessonWidget(pointThresholdPage);
+void MainWindow::leaveLesson()
+{
+    if (activeLesson < 0)
+    {
+        return;
+    }
+    if (LessonLifecycle *lifecycle = lessonLifecycles[static_cast<size_t>(activeLesson)])
+    {
+        lifecycle->deactivate();
+    }
+    activeLesson = -1;
+    suspendTimer->start();
+}
 
-    pointThresholdLayout->addWidget(pointThresholdBackButton, 0, Qt::AlignLeft);
-    pointThresholdLayout->addWidget(pointThresholdLesson, 1);
+void MainWindow::suspendLesson(int lessonIndex)
+{
+    LessonLifecycle *lifecycle = lessonLifecycles[static_cast<size_t>(lessonIndex)];
+    if (!lifecycle || lessonIndex == activeLesson || lessonSuspended[static_cast<size_t>(lessonIndex)])
+    {
+        return;
+    }
+    // 挂起时生成的预览（以及释放）记到该课程，而不是当前前台的课程
+    TRACE_SCOPE("lesson suspend");
+    memory_accounting::Scope tag(lessonIndex, "suspend");
+    lifecycle->suspend();
+    lessonSuspended[static_cast<size_t>(lessonIndex)] = true;
+}
 
-    auto *pointContrastPage = new QWidget();
-    auto *pointContrastLayout = new QVBoxLayout(pointContrastPage);
-    auto *pointContrastBackButton = new QPushButton(QStringLiteral("返回首页"), pointContrastPage);
-    auto *pointContrastLesson = new PointContrastStretchLessonWidget(pointContrastPage);
+void MainWindow::suspendHiddenLessons()
+{
+    for (size_t i = 0; i < lessonPages.size(); ++i)
+    {
+        if (lessonPages[i])
+        {
+            suspendLesson(static_cast<int>(i));
+        }
+    }
+    // 挂起释放的缓冲区先进了 MatPool，归还给系统才算真正让出内存
+    MatPool::instance().trim();
+}
 
-    pointContrastLayout->addWidget(pointContrastBackButton, 0, Qt::AlignLeft);
-    pointContrastLayout->addWidget(pointContrastLesson, 1);
+void MainWindow::setMemoryBudget(int budgetMiB)
+{
+    // 超限回调可能来自任意分配线程，而且可能在窗口析构期间取到回调：不直接碰 this，
+    // 只向应用对象排队，到 GUI 线程上再确认窗口还在
+    const QPointer<MainWindow> window = this;
+    memory_accounting::setBudget(static_cast<size_t>(budgetMiB) * 1024 * 1024, [window]() {
+        if (QCoreApplication *app = QCoreApplication::instance())
+        {
+            QMetaObject::invokeMethod(app, [window]() {
+                if (window)
+                {
+                    window->reclaimMemory(true);
+                }
+            }, Qt::QueuedConnection);
+        }
+    });
+    if (budgetMiB > 0 && memory_accounting::liveBytes() > memory_accounting::budget())
+    {
+        reclaimMemory(true);
+    }
+}
 
-    stack->addWidget(homePage);
-    stack->addWidget(imwritePage);
-    stack->addWidget(imreadPage);
-    stack->addWidget(namedWindowPage);
-    stack->addWidget(morphologyPage);
-    stack->addWidget(erosionBoundaryPage);
-    stack->addWidget(pointGrayPage);
-    stack->addWidget(pointHistogramPage);
-    stack->addWidget(pointTruncationPage);
-    stack->addWidget(pointColorPage);
-    stack->addWidget(pointInvertPage);
-    stack->addWidget(pointThresholdPage);
-    stack->addWidget(pointContrastPage);
+void MainWindow::reclaimMemory(bool untilUnderBudget)
+{
+    const size_t before = memory_accounting::liveBytes();
+    const size_t budget = memory_accounting::budget();
+    const auto satisfied = [untilUnderBudget, budget]() {
+        return untilUnderBudget && (budget == 0 || memory_accounting::liveBytes() <= budget);
+    };
 
-    QObject::connect(lessonList, &QListWidget::itemClicked, stack, [this](QListWidgetItem *item) {
-        const int pageIndex = item->data(Qt::UserRole).toInt();
-        stack->setCurrentIndex(pageIndex);
-    });
-    QObject::connect(imwriteBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(imreadBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(namedWindowBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(morphologyBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(erosionBoundaryBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(pointGrayBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(pointHistogramBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(pointTruncationBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(pointColorBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(pointInvertBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(pointThresholdBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
-    QObject::connect(pointContrastBackButton, &QPushButton::clicked, stack, [this]() {
-        stack->setCurrentIndex(HomePageIndex);
-    });
+    // 先归还池中空闲缓冲区，再从最久未访问的课程开始挂起不可见的课程（只留压缩状态），
+    // 然后淘汰解码缓存里没人引用的图像
+    MatPool::instance().trim();
+    QStringList actions;
+    // 回收全部时页面反正要销毁，跳过挂起
+    for (auto it = recentLessons.rbegin(); untilUnderBudget && it != recentLessons.rend() && !satisfied(); ++it)
+    {
+        const size_t index = static_cast<size_t>(*it);
+        if (!lessonPages[index] || !lessonLifecycles[index] || lessonSuspended[index] || *it == activeLesson)
+        {
+            continue;
+        }
+        const size_t lessonBytes = memory_accounting::lessonBytes(*it);
+        suspendLesson(*it);
+        MatPool::instance().trim();
+        actions.append(QStringLiteral("挂起「%1」%2 → %3 MiB")
+                           .arg(lessonRegistry()[index].title)
+                           .arg(lessonBytes / 1048576.0, 0, 'f', 1)
+                           .arg(memory_accounting::lessonBytes(*it) / 1048576.0, 0, 'f', 1));
+    }
+    // 解码缓存只丢掉已没有课程引用的图像：仍被引用的丢掉也不会释放内存，
+    // 下次读取同一文件反而会再解码一份
+    if (!satisfied())
+    {
+        const size_t evicted = ImageCache::instance().evictUnreferenced();
+        MatPool::instance().trim();
+        actions.append(QStringLiteral("淘汰解码缓存 %1 MiB").arg(evicted / 1048576.0, 0, 'f', 1));
+    }
 
-    setWindowTitle(QStringLiteral("Qt + OpenCV 学习项目"));
-    setCentralWidget(stack);
-    resize(800, 600);
+    // 仍然不够时销毁不可见的页面（连同其压缩状态和 HighGUI 窗口），下次进入时按需重新创建
+    for (auto it = recentLessons.rbegin(); it != recentLessons.rend() && !satisfied(); ++it)
+    {
+        QWidget *&page = lessonPages[static_cast<size_t>(*it)];
+        if (!page || page == stack->currentWidget())
+        {
+            continue;
+        }
+        const size_t lessonBytes = memory_accounting::lessonBytes(*it);
+        stack->removeWidget(page);
+        delete page;
+        page = nullptr;
+        lessonLifecycles[static_cast<size_t>(*it)] = nullptr;
+        lessonSuspended[static_cast<size_t>(*it)] = false;
+        // 页面释放了对缓存图像的引用，这些条目现在可以淘汰了
+        ImageCache::instance().evictUnreferenced();
+        MatPool::instance().trim();
+        actions.append(QStringLiteral("回收「%1」%2 MiB")
+                           .arg(lessonRegistry()[static_cast<size_t>(*it)].title)
+                           .arg(lessonBytes / 1048576.0, 0, 'f', 1));
+    }
+
+    const size_t after = memory_accounting::liveBytes();
+    memoryPanel->setReport(QStringLiteral("%1：%2 → %3 MiB%4")
+                               .arg(QDateTime::currentDateTime().toString(QStringLiteral("HH:mm:ss")))
+                               .arg(before / 1048576.0, 0, 'f', 1)
+                               .arg(after / 1048576.0, 0, 'f', 1)
+                               .arg(actions.isEmpty() ? QString() : QStringLiteral("（%1）").arg(actions.join(QStringLiteral("，")))));
+    // 只剩当前课程仍超出预算时不再重复触发，等切换课程或修改预算后再检查
+    if (budget == 0 || after <= budget)
+    {
+        memory_accounting::rearm();
+    }
 }
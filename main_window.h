@@ -2,18 +2,54 @@
 
 #include <QMainWindow>
 
+#include <vector>
+
+class LessonLifecycle;
+class MemoryPanel;
+class QDockWidget;
 class QStackedWidget;
+class QTimer;
+class TraceOverlay;
 class QListWidget;
-class QPushButton;
+class QWidget;
 
 class MainWindow : public QMainWindow
 {
 public:
     explicit MainWindow(QWidget *parent = nullptr);
+    ~MainWindow() override;
+
+protected:
+    // 跟踪开启时，把鼠标/键盘输入记为一次新交互的开始
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
     QStackedWidget *stack = nullptr;
+    QWidget *homePage = nullptr;
     QListWidget *lessonList = nullptr;
-    QPushButton *imwriteBackButton = nullptr;
-    QPushButton *imreadBackButton = nullptr;
+    // 与 lessonRegistry() 一一对应；尚未进入过的课程为 nullptr
+    std::vector<QWidget *> lessonPages;
+    // 与 lessonPages 对应：课程控件实现了 LessonLifecycle 时指向它，否则为 nullptr
+    std::vector<LessonLifecycle *> lessonLifecycles;
+    std::vector<bool> lessonSuspended;
+    int activeLesson = -1; // 当前在前台的课程，首页时为 -1
+    // 离开课程后延时挂起：很快切回来时不必重建，长时间不用的课程只保留压缩状态
+    QTimer *suspendTimer = nullptr;
+    TraceOverlay *traceOverlay = nullptr;
+    QDockWidget *memoryDock = nullptr;
+    MemoryPanel *memoryPanel = nullptr;
+    // 最近进入的课程在前，超出内存预算时从末尾（最久未访问）开始回收
+    std::vector<int> recentLessons;
+
+    void showLesson(int lessonIndex);
+    QWidget *createLessonPage(int lessonIndex);
+    // 让前台课程 deactivate，并开始挂起计时
+    void leaveLesson();
+    void suspendLesson(int lessonIndex);
+    void suspendHiddenLessons();
+    void setTracing(bool enabled);
+    void setMemoryBudget(int budgetMiB);
+    // untilUnderBudget 为 false 时回收全部不可见课程
+    void reclaimMemory(bool untilUnderBudget);
+    void exportTrace();
 };
@@ -0,0 +1,267 @@
+#include "mat_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+
+#include "large_pages.h"
+#include "memory_accounting.h"
+
+namespace
+{
+constexpr size_t kLargeThresholdBytes = size_t(8) * 1024 * 1024;
+
+bool hugePagesRequested()
+{
+    const char *value = std::getenv("OPENCV_LESSONS_HUGE_PAGES");
+    return value && *value && *value != '0';
+}
+
+// 空闲上限至少放得下这么多块最大的缓冲区
+constexpr size_t kAutoLimitBuffers = 2;
+} // namespace
+
+MatPool &MatPool::instance()
+{
+    // 故意不析构：静态对象销毁之后仍可能有全局 Mat 释放
+    static MatPool *pool = [] {
+        auto *created = new MatPool();
+        created->counters.limitBytes = size_t(256) * 1024 * 1024;
+        return created;
+    }();
+    return *pool;
+}
+
+void MatPool::install()
+{
+    MatPool &pool = instance();
+    if (const char *limitEnv = std::getenv("OPENCV_LESSONS_POOL_MB"))
+    {
+        pool.setLimitBytes(static_cast<size_t>(std::max(0, std::atoi(limitEnv))) * 1024 * 1024);
+    }
+#ifdef __linux__
+    if (hugePagesRequested())
+    {
+        pool.largeThreshold = kLargeThresholdBytes;
+        pool.counters.largeThresholdBytes = kLargeThresholdBytes;
+    }
+#endif
+    cv::Mat::setDefaultAllocator(&pool);
+}
+
+size_t MatPool::bucketBytes(size_t bytes) const
+{
+    const size_t granule = bytes < 4096 ? 64 : 4096;
+    const size_t bucket = (bytes + granule - 1) / granule * granule;
+    if (isLarge(bucket))
+    {
+        // 阈值本身是 2 MiB 的倍数，所以普通桶总小于阈值，两条路径的桶不会混用
+        return (bucket + large_pages::kHugePageBytes - 1) / large_pages::kHugePageBytes * large_pages::kHugePageBytes;
+    }
+    return bucket;
+}
+
+bool MatPool::isLarge(size_t bucket) const
+{
+    return largeThreshold > 0 && bucket >= largeThreshold;
+}
+
+void *MatPool::allocateBuffer(size_t bucket) const
+{
+    if (!isLarge(bucket))
+    {
+        return cv::fastMalloc(bucket);
+    }
+
+    large_pages::Kind kind = large_pages::Kind::None;
+    void *buffer = large_pages::allocate(bucket, true, &kind);
+    if (!buffer)
+    {
+        CV_Error(cv::Error::StsNoMem, "MatPool: failed to map large pages");
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    ++counters.largeAllocations;
+    if (kind == large_pages::Kind::HugeTlb)
+    {
+        ++counters.hugeTlbAllocations;
+    }
+    return buffer;
+}
+
+bool MatPool::freeBuffer(void *buffer, size_t bucket) const
+{
+    if (isLarge(bucket))
+    {
+        return large_pages::release(buffer, bucket);
+    }
+    cv::fastFree(buffer);
+    return true;
+}
+
+cv::UMatData *MatPool::allocate(int dims,
+                                const int *sizes,
+                                int type,
+                                void *data0,
+                                size_t *step,
+                                cv::AccessFlag /*flags*/,
+                                cv::UMatUsageFlags /*usageFlags*/) const
+{
+    // 行跨度计算与 OpenCV 的 StdMatAllocator 相同
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; --i)
+    {
+        if (step)
+        {
+            if (data0 && step[i] != CV_AUTOSTEP)
+            {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            }
+            else
+            {
+                step[i] = total;
+            }
+        }
+        total *= static_cast<size_t>(sizes[i]);
+    }
+
+    if (data0)
+    {
+        auto *u = new cv::UMatData(this);
+        u->size = total;
+        u->data = u->origdata = static_cast<uchar *>(data0);
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+        return u;
+    }
+
+    const size_t bucket = bucketBytes(total);
+    cv::UMatData *u = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = freeLists.find(bucket);
+        if (it != freeLists.end() && !it->second.empty())
+        {
+            u = it->second.back();
+            it->second.pop_back();
+            counters.pooledBytes -= bucket;
+            ++counters.hits;
+        }
+        else
+        {
+            ++counters.misses;
+            if (autoLimit)
+            {
+                counters.limitBytes = std::max(counters.limitBytes, kAutoLimitBuffers * bucket);
+            }
+        }
+    }
+
+    void *buffer = nullptr;
+    if (u)
+    {
+        // 复用池里的 UMatData：原地重新构造，清掉上次使用留下的引用计数和标志
+        buffer = u->origdata;
+        u->origdata = nullptr;
+        u->~UMatData();
+        new (u) cv::UMatData(this);
+    }
+    else
+    {
+        buffer = allocateBuffer(bucket);
+        u = new cv::UMatData(this);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.inUseBytes += bucket;
+        counters.peakBytes = std::max(counters.peakBytes, counters.inUseBytes + counters.pooledBytes);
+    }
+
+    u->size = total;
+    u->data = u->origdata = static_cast<uchar *>(buffer);
+    // 记账标签存在分配器私有字段里，释放时按同一标签扣回
+    u->allocatorFlags_ = memory_accounting::recordAllocation(bucket);
+    return u;
+}
+
+bool MatPool::allocate(cv::UMatData *data, cv::AccessFlag, cv::UMatUsageFlags) const
+{
+    return data != nullptr;
+}
+
+void MatPool::deallocate(cv::UMatData *u) const
+{
+    if (!u)
+    {
+        return;
+    }
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED))
+    {
+        const size_t bucket = bucketBytes(u->size);
+        memory_accounting::recordRelease(u->allocatorFlags_, bucket);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            counters.inUseBytes -= bucket;
+            if (counters.pooledBytes + bucket <= counters.limitBytes)
+            {
+                std::vector<cv::UMatData *> &list = freeLists[bucket];
+                // 第一次放入该桶时 vector 会分配；之后容量保持，稳态下不再分配。
+                // UMatData 连同缓冲区一起留在池里，下次分配时原地重新构造
+                list.push_back(u);
+                counters.pooledBytes += bucket;
+                return;
+            }
+        }
+        if (!freeBuffer(u->origdata, bucket))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++counters.releaseFailures;
+        }
+        u->origdata = nullptr;
+    }
+    delete u;
+}
+
+void MatPool::setLimitBytes(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    autoLimit = false;
+    counters.limitBytes = bytes;
+    trimLocked(bytes);
+}
+
+void MatPool::trim()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    trimLocked(0);
+}
+
+MatPool::Stats MatPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void MatPool::trimLocked(size_t limit) const
+{
+    for (auto it = freeLists.begin(); it != freeLists.end() && counters.pooledBytes > limit;)
+    {
+        std::vector<cv::UMatData *> &list = it->second;
+        while (!list.empty() && counters.pooledBytes > limit)
+        {
+            cv::UMatData *u = list.back();
+            list.pop_back();
+            if (!freeBuffer(u->origdata, it->first))
+            {
+                ++counters.releaseFailures;
+            }
+            u->origdata = nullptr;
+            delete u;
+            counters.pooledBytes -= it->first;
+        }
+        it = list.empty() ? freeLists.erase(it) : std::next(it);
+    }
+}
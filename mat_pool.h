@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// 按字节数分桶的 Mat 缓冲区池，实现为 cv::MatAllocator 并在启动时设为默认分配器：
+// 拖动滑动条时每一帧的输出、split 出的通道、clone 出的显示缓冲区尺寸和类型都不变，
+// 释放的缓冲区连同它的 UMatData 回到同尺寸的桶里，下一帧直接复用，稳态下像素内存和
+// Mat 头部的 UMatData 都不再向堆申请。
+// 桶按 64 字节（小于 4 KiB）或 4 KiB 取整；空闲缓冲区超过上限时直接归还系统。
+// 上限默认 256 MiB，并自动提高到至少能放下两块见过的最大缓冲区（一幅全分辨率的输入和输出），
+// 大图拖动时不会每帧都把整幅缓冲区还给系统再重新申请；
+// 环境变量 OPENCV_LESSONS_POOL_MB 或 setLimitBytes 给出固定上限，此后不再自动提高。
+// 线程安全，工作线程和线程池里的分配也走这里。
+// 借出的缓冲区按当前线程的（课程，阶段）标签记账，见 memory_accounting。
+//
+// 可选大页（环境变量 OPENCV_LESSONS_HUGE_PAGES=1 开启，只在启动时读取）：
+// 不小于 8 MiB 的缓冲区改用 large_pages 分配（2 MiB 取整、预先并行触碰），
+// 几百 MB 的图像不再在第一遍处理时按 4 KiB 逐页缺页。
+class MatPool : public cv::MatAllocator
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        size_t inUseBytes = 0;  // 已借出
+        size_t pooledBytes = 0; // 空闲待复用
+        size_t peakBytes = 0;   // inUse + pooled 的历史峰值
+        size_t limitBytes = 0;  // 当前生效的空闲上限
+        std::uint64_t releaseFailures = 0; // 归还系统失败（大页 munmap 出错）的缓冲区数，这些内存已泄漏
+        std::uint64_t largeAllocations = 0; // 走大页路径的新分配（不含池命中）
+        std::uint64_t hugeTlbAllocations = 0;
+        size_t largeThresholdBytes = 0;     // 0 表示未开启大页
+
+        double hitRate() const
+        {
+            const std::uint64_t total = hits + misses;
+            return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+        }
+    };
+
+    static MatPool &instance();
+    // 设为 cv::Mat 的默认分配器；之前已分配的 Mat 仍由原分配器释放。
+    // 须在任何分配之前调用，大页开关和 OPENCV_LESSONS_POOL_MB 此后不再读取
+    static void install();
+
+    cv::UMatData *allocate(int dims,
+                           const int *sizes,
+                           int type,
+                           void *data,
+                           size_t *step,
+                           cv::AccessFlag flags,
+                           cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData *data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData *data) const override;
+
+    // 固定空闲上限并立即归还超出的部分，之后不再按最大缓冲区自动提高
+    void setLimitBytes(size_t bytes);
+    // 归还所有空闲缓冲区
+    void trim();
+    Stats stats() const;
+
+private:
+    MatPool() = default;
+
+    size_t bucketBytes(size_t bytes) const;
+    bool isLarge(size_t bucket) const;
+    void *allocateBuffer(size_t bucket) const;
+    bool freeBuffer(void *buffer, size_t bucket) const;
+    void trimLocked(size_t limit) const;
+
+    mutable std::mutex mutex;
+    // 空闲的 UMatData，origdata 仍指向它的缓冲区
+    mutable std::unordered_map<size_t, std::vector<cv::UMatData *>> freeLists;
+    mutable Stats counters;
+    bool autoLimit = true;
+    size_t largeThreshold = 0;
+};
@@ -1,34 +1,377 @@
 #include "mat_to_qimage.h"
 
-QImage matToQImage(const cv::Mat &mat)
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core/hal/intrin.hpp>
+
+#include "trace.h"
+
+namespace
+{
+// QImage 释放时调用：归还包装时持有的 Mat 引用
+void releaseSharedMat(void *info)
+{
+    delete static_cast<cv::Mat *>(info);
+}
+
+// 四通道输出格式：小端机器上 Format_ARGB32 的字节序是 B,G,R,A，与 BGRA 一致；
+// 大端机器上只能用 Format_RGBA8888，写入时交换 B/R。
+constexpr bool kArgb32MatchesBgra = Q_BYTE_ORDER == Q_LITTLE_ENDIAN;
+
+// 与 Mat 内存布局一一对应的 QImage 格式：BGR 字节序正好是 Format_BGR888，
+// 因此 8 位图像都不需要交换通道。
+QImage::Format directFormat(int type)
+{
+    switch (type)
+    {
+    case CV_8UC1:
+        return QImage::Format_Grayscale8;
+    case CV_8UC3:
+        return QImage::Format_BGR888;
+    case CV_8UC4:
+        return kArgb32MatchesBgra ? QImage::Format_ARGB32 : QImage::Format_Invalid;
+    default:
+        return QImage::Format_Invalid;
+    }
+}
+
+// 32 位格式在 Qt 内部按 quint32 读取，要求首地址和行跨度都 4 字节对齐；
+// 8/24 位格式按字节访问，任意跨度都可以直接包装。
+bool canShare(const cv::Mat &mat, QImage::Format format)
+{
+    if (format != QImage::Format_ARGB32)
+    {
+        return true;
+    }
+    const auto address = reinterpret_cast<std::uintptr_t>(mat.data);
+    return address % 4 == 0 && mat.step % 4 == 0;
+}
+
+// gamma 查找表的输入精度：窗口内的值先量化到 12 位，再查表得到 8 位输出
+constexpr int kGammaLutSize = 4096;
+
+// 单次遍历用到的映射参数：v = (x - low) * scale
+// gamma == 1 时 scale 直接映射到 [0, 255]；否则映射到查找表下标 [0, kGammaLutSize - 1]
+struct ToneCurve
+{
+    float low = 0.0f;
+    float scale = 1.0f;
+    std::vector<uchar> gammaLut;
+};
+
+ToneCurve makeToneCurve(const ToneMapping &toneMapping, double defaultHigh)
+{
+    double low = toneMapping.windowLow;
+    double high = toneMapping.windowHigh;
+    if (!(high > low))
+    {
+        low = 0.0;
+        high = defaultHigh;
+    }
+
+    ToneCurve curve;
+    curve.low = static_cast<float>(low);
+    if (std::abs(toneMapping.gamma - 1.0) < 1e-6)
+    {
+        curve.scale = static_cast<float>(255.0 / (high - low));
+        return curve;
+    }
+
+    curve.scale = static_cast<float>((kGammaLutSize - 1) / (high - low));
+    curve.gammaLut.resize(kGammaLutSize);
+    for (int i = 0; i < kGammaLutSize; ++i)
+    {
+        const double normalized = static_cast<double>(i) / (kGammaLutSize - 1);
+        curve.gammaLut[i] = cv::saturate_cast<uchar>(std::pow(normalized, toneMapping.gamma) * 255.0);
+    }
+    return curve;
+}
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+// 一次读入 2 个 v_float32 宽度的样本
+inline void loadAsFloat(const float *src, cv::v_float32 &a, cv::v_float32 &b)
+{
+    a = cv::vx_load(src);
+    b = cv::vx_load(src + cv::VTraits<cv::v_float32>::vlanes());
+}
+
+inline void loadAsFloat(const ushort *src, cv::v_float32 &a, cv::v_float32 &b)
+{
+    cv::v_uint32 lo;
+    cv::v_uint32 hi;
+    cv::v_expand(cv::vx_load(src), lo, hi);
+    a = cv::v_cvt_f32(cv::v_reinterpret_as_s32(lo));
+    b = cv::v_cvt_f32(cv::v_reinterpret_as_s32(hi));
+}
+#endif
+
+// 把一行样本（通道交错，共 n 个）映射成 8 位，直接写进 QImage 的扫描行
+template <typename T>
+void toneMapRow(const T *src, uchar *dst, int n, const ToneCurve &curve)
+{
+    const bool useGamma = !curve.gammaLut.empty();
+    // 先在浮点域截到 [0, high] 再取整：超出 int32 的值（包括 ±inf）取整后是未定义的“整数不定值”，
+    // 不能指望之后的整数饱和；NaN 两条路径都得到 0
+    const float high = useGamma ? static_cast<float>(kGammaLutSize - 1) : 255.0f;
+    int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    using namespace cv;
+    const int lanes = VTraits<v_float32>::vlanes();
+    const int step = lanes * 4;
+    const v_float32 vlow = vx_setall_f32(curve.low);
+    const v_float32 vscale = vx_setall_f32(curve.scale);
+    const v_float32 vzero = vx_setzero_f32();
+    const v_float32 vhigh = vx_setall_f32(high);
+    const auto toIndex = [&](const v_float32 &f) {
+        // v_max 的第二个操作数是 0：x86 上任一操作数为 NaN 时返回第二个操作数
+        return v_round(v_min(v_max(v_mul(v_sub(f, vlow), vscale), vzero), vhigh));
+    };
+    int indices[VTraits<v_int32>::max_nlanes * 4];
+
+    for (; x <= n - step; x += step)
+    {
+        v_float32 f0, f1, f2, f3;
+        loadAsFloat(src + x, f0, f1);
+        loadAsFloat(src + x + lanes * 2, f2, f3);
+
+        const v_int32 i0 = toIndex(f0);
+        const v_int32 i1 = toIndex(f1);
+        const v_int32 i2 = toIndex(f2);
+        const v_int32 i3 = toIndex(f3);
+
+        if (!useGamma)
+        {
+            // 已在 [0, 255] 内，打包 int32 → uint16 → uint8 不会再截断
+            v_store(dst + x, v_pack(v_pack_u(i0, i1), v_pack_u(i2, i3)));
+            continue;
+        }
+
+        v_store(indices, i0);
+        v_store(indices + lanes, i1);
+        v_store(indices + lanes * 2, i2);
+        v_store(indices + lanes * 3, i3);
+        for (int j = 0; j < step; ++j)
+        {
+            dst[x + j] = curve.gammaLut[indices[j]];
+        }
+    }
+#endif
+    for (; x < n; ++x)
+    {
+        const float v = (static_cast<float>(src[x]) - curve.low) * curve.scale;
+        // 写成 v > 0 的形式让 NaN 落到 0
+        const int index = cvRound(v > 0.0f ? std::min(v, high) : 0.0f);
+        dst[x] = useGamma ? curve.gammaLut[index] : static_cast<uchar>(index);
+    }
+}
+
+// Alpha 只做位深缩放，不走窗宽窗位
+inline uchar scaleAlpha(ushort a)
+{
+    return static_cast<uchar>((static_cast<unsigned>(a) * 255u + 32767u) / 65535u);
+}
+
+inline uchar scaleAlpha(float a)
+{
+    return cv::saturate_cast<uchar>(a * 255.0f);
+}
+
+template <typename T>
+void fixupFourChannelRow(const T *src, uchar *dst, int cols)
 {
+    for (int x = 0; x < cols; ++x)
+    {
+        dst[x * 4 + 3] = scaleAlpha(src[x * 4 + 3]);
+        if (!kArgb32MatchesBgra)
+        {
+            std::swap(dst[x * 4], dst[x * 4 + 2]);
+        }
+    }
+}
+
+template <typename T>
+void toneMapImage(const cv::Mat &mat, uchar *bits, qsizetype bytesPerLine, const ToneCurve &curve)
+{
+    const int cn = mat.channels();
+    const int samplesPerRow = mat.cols * cn;
+    cv::parallel_for_(cv::Range(0, mat.rows), [&](const cv::Range &range) {
+        for (int y = range.start; y < range.end; ++y)
+        {
+            const T *src = mat.ptr<T>(y);
+            uchar *dst = bits + static_cast<qsizetype>(y) * bytesPerLine;
+            toneMapRow(src, dst, samplesPerRow, curve);
+            if (cn == 4)
+            {
+                fixupFourChannelRow(src, dst, mat.cols);
+            }
+        }
+    });
+}
+
+// CV_8UC2 按“灰度 + Alpha”解释，展开成 RGBA8888（R=G=B=灰度，与字节序无关）
+void expandGrayAlphaRow(const uchar *src, uchar *dst, int cols)
+{
+    int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    using namespace cv;
+    const int lanes = VTraits<v_uint8>::vlanes();
+    for (; x <= cols - lanes; x += lanes)
+    {
+        v_uint8 gray;
+        v_uint8 alpha;
+        v_load_deinterleave(src + x * 2, gray, alpha);
+        v_store_interleave(dst + x * 4, gray, gray, gray, alpha);
+    }
+#endif
+    for (; x < cols; ++x)
+    {
+        dst[x * 4] = src[x * 2];
+        dst[x * 4 + 1] = src[x * 2];
+        dst[x * 4 + 2] = src[x * 2];
+        dst[x * 4 + 3] = src[x * 2 + 1];
+    }
+}
+
+QImage grayAlphaToQImage(const cv::Mat &mat)
+{
+    QImage image(mat.cols, mat.rows, QImage::Format_RGBA8888);
+    if (image.isNull())
+    {
+        return {};
+    }
+
+    // 先取出缓冲区指针再并行写入，避免多个线程同时调用 scanLine() 触发 detach
+    uchar *bits = image.bits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    cv::parallel_for_(cv::Range(0, mat.rows), [&](const cv::Range &range) {
+        for (int y = range.start; y < range.end; ++y)
+        {
+            expandGrayAlphaRow(mat.ptr<uchar>(y), bits + static_cast<qsizetype>(y) * bytesPerLine, mat.cols);
+        }
+    });
+    return image;
+}
+} // namespace
+
+QImage matToQImage(const cv::Mat &mat, MatToQImageMode mode)
+{
+    TRACE_SCOPE("matToQImage");
     if (mat.empty())
     {
         return {};
     }
 
-    switch (mat.type())
+    if (mat.depth() != CV_8U)
     {
-    case CV_8UC1:
+        return matToQImage(mat, ToneMapping{});
+    }
+
+    if (mat.type() == CV_8UC2)
     {
-        QImage image(mat.data, mat.cols, mat.rows, static_cast<int>(mat.step), QImage::Format_Grayscale8);
-        return image.copy();
+        return grayAlphaToQImage(mat);
     }
-    case CV_8UC3:
+
+    const QImage::Format format = directFormat(mat.type());
+    if (format == QImage::Format_Invalid)
     {
-        cv::Mat rgb;
-        cv::cvtColor(mat, rgb, cv::COLOR_BGR2RGB);
-        QImage image(rgb.data, rgb.cols, rgb.rows, static_cast<int>(rgb.step), QImage::Format_RGB888);
-        return image.copy();
+        if (mat.type() != CV_8UC4)
+        {
+            return {};
+        }
+
+        // 大端平台：ARGB32 的字节序与 BGRA 不同，只能交换通道，直接写进 QImage 的缓冲区
+        QImage image(mat.cols, mat.rows, QImage::Format_RGBA8888);
+        if (image.isNull())
+        {
+            return {};
+        }
+        cv::Mat target(mat.rows, mat.cols, CV_8UC4, image.bits(), static_cast<size_t>(image.bytesPerLine()));
+        cv::cvtColor(mat, target, cv::COLOR_BGRA2RGBA);
+        return image;
     }
-    case CV_8UC4:
+
+    if (mode == MatToQImageMode::Share && canShare(mat, format))
     {
-        cv::Mat rgba;
-        cv::cvtColor(mat, rgba, cv::COLOR_BGRA2RGBA);
-        QImage image(rgba.data, rgba.cols, rgba.rows, static_cast<int>(rgba.step), QImage::Format_RGBA8888);
-        return image.copy();
+        // 堆上的 Mat 头持有一份引用计数，QImage 析构时由 releaseSharedMat 释放。
+        // 传入 const 指针得到只读 QImage，任何写操作都会让 QImage 自动分离出副本，不会改到 Mat。
+        auto *holder = new cv::Mat(mat);
+        return QImage(static_cast<const uchar *>(holder->data),
+                      holder->cols,
+                      holder->rows,
+                      static_cast<qsizetype>(holder->step),
+                      format,
+                      releaseSharedMat,
+                      holder);
     }
+
+    // 拷贝模式：逐行写进 QImage 自己的缓冲区，整个过程只有一次拷贝
+    QImage image(mat.cols, mat.rows, format);
+    if (image.isNull())
+    {
+        return {};
+    }
+    cv::Mat target(mat.rows, mat.cols, mat.type(), image.bits(), static_cast<size_t>(image.bytesPerLine()));
+    mat.copyTo(target);
+    return image;
+}
+
+QImage matToQImage(const cv::Mat &mat, const ToneMapping &toneMapping)
+{
+    TRACE_SCOPE("matToQImage tone");
+    if (mat.empty())
+    {
+        return {};
+    }
+
+    if (mat.depth() == CV_8U)
+    {
+        return matToQImage(mat, MatToQImageMode::Copy);
+    }
+
+    const int depth = mat.depth();
+    if (depth != CV_16U && depth != CV_32F)
+    {
+        return {};
+    }
+
+    QImage::Format format = QImage::Format_Invalid;
+    switch (mat.channels())
+    {
+    case 1:
+        format = QImage::Format_Grayscale8;
+        break;
+    case 3:
+        format = QImage::Format_BGR888;
+        break;
+    case 4:
+        format = kArgb32MatchesBgra ? QImage::Format_ARGB32 : QImage::Format_RGBA8888;
+        break;
     default:
         return {};
     }
+
+    QImage image(mat.cols, mat.rows, format);
+    if (image.isNull())
+    {
+        return {};
+    }
+
+    // 单次遍历：读源像素 → 窗宽窗位/gamma → 直接写入 QImage，不产生 convertTo/normalize 临时图
+    uchar *bits = image.bits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    if (depth == CV_16U)
+    {
+        toneMapImage<ushort>(mat, bits, bytesPerLine, makeToneCurve(toneMapping, 65535.0));
+    }
+    else
+    {
+        toneMapImage<float>(mat, bits, bytesPerLine, makeToneCurve(toneMapping, 1.0));
+    }
+    return image;
 }
@@ -3,4 +3,28 @@
 #include <QImage>
 #include <opencv2/opencv.hpp>
 
-QImage matToQImage(const cv::Mat &mat);
+// 转换方式：
+// Copy  - 返回独立的深拷贝，之后可以随意修改或释放 Mat。
+// Share - 零拷贝：QImage 直接包装 Mat 的像素缓冲区，并通过清理函数持有 Mat 的引用计数，
+//         只有当 stride/对齐不满足 Qt 要求时才退化为拷贝。共享期间不要原地修改 Mat。
+//         只对 CV_8UC1/3/4 生效，其余类型总是转换成新的 8 位 QImage。
+enum class MatToQImageMode
+{
+    Copy,
+    Share
+};
+
+// 高位深/浮点图像的显示映射（窗宽窗位 + gamma）：
+// 先把 [windowLow, windowHigh] 线性映射到 [0, 1]，再做 out = in^gamma，最后量化到 0~255。
+// windowHigh <= windowLow 时使用该位深的默认窗口：16 位为 [0, 65535]，浮点为 [0, 1]。
+// Alpha 通道不参与映射，只做位深缩放。
+struct ToneMapping
+{
+    double windowLow = 0.0;
+    double windowHigh = 0.0;
+    double gamma = 1.0;
+};
+
+// 支持 CV_8UC1/2/3/4、CV_16UC1/3/4、CV_32FC1/3/4，其余类型返回空 QImage。
+QImage matToQImage(const cv::Mat &mat, MatToQImageMode mode = MatToQImageMode::Copy);
+QImage matToQImage(const cv::Mat &mat, const ToneMapping &toneMapping);
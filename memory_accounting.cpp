@@ -0,0 +1,214 @@
+#include "memory_accounting.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace memory_accounting
+{
+namespace
+{
+struct Counters
+{
+    int lesson = kSharedLesson;
+    const char *stage = nullptr;
+    std::atomic<size_t> liveBytes{0};
+    std::atomic<size_t> peakBytes{0};
+    std::atomic<std::uint64_t> allocations{0};
+};
+
+// 标签只增不删、容量固定：登记新标签要持锁，已登记的计数器可以无锁按下标访问。
+// 课程数 × 阶段数远小于容量；万一用完，新组合记到最后一个槽位
+constexpr size_t kMaxTags = 256;
+
+struct Registry
+{
+    std::mutex mutex;
+    std::array<Counters, kMaxTags> tags;
+    std::atomic<size_t> count{0};
+    std::function<void()> onExceeded;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+constexpr const char *kDefaultStage = "other";
+
+thread_local int threadLesson = kSharedLesson;
+thread_local const char *threadStage = kDefaultStage;
+// 上次查到的标签，同一 (lesson, stage) 连续分配时免去查找
+thread_local int cachedTag = -1;
+thread_local int cachedLesson = kSharedLesson;
+thread_local const char *cachedStage = nullptr;
+
+std::atomic<size_t> totalLive{0};
+std::atomic<size_t> budgetBytes{0};
+std::atomic<bool> exceededFired{false};
+
+int findOrRegister(int lesson, const char *stage)
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    const size_t count = reg.count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Counters &counters = reg.tags[i];
+        if (counters.lesson == lesson && (counters.stage == stage || std::strcmp(counters.stage, stage) == 0))
+        {
+            return static_cast<int>(i);
+        }
+    }
+    if (count == kMaxTags)
+    {
+        return static_cast<int>(kMaxTags - 1);
+    }
+    reg.tags[count].lesson = lesson;
+    reg.tags[count].stage = stage;
+    reg.count.store(count + 1, std::memory_order_release);
+    return static_cast<int>(count);
+}
+
+Counters &countersFor(int tag)
+{
+    return registry().tags[static_cast<size_t>(tag)];
+}
+} // namespace
+
+int currentLesson()
+{
+    return threadLesson;
+}
+
+void setCurrentLesson(int lesson)
+{
+    threadLesson = lesson;
+}
+
+Scope::Scope(int lesson, const char *stage)
+    : previousLesson(threadLesson)
+    , previousStage(threadStage)
+{
+    threadLesson = lesson;
+    threadStage = stage;
+}
+
+Scope::Scope(const char *stage)
+    : Scope(threadLesson, stage)
+{
+}
+
+Scope::~Scope()
+{
+    threadLesson = previousLesson;
+    threadStage = previousStage;
+}
+
+int recordAllocation(size_t bytes)
+{
+    if (cachedTag < 0 || cachedLesson != threadLesson || cachedStage != threadStage)
+    {
+        cachedTag = findOrRegister(threadLesson, threadStage);
+        cachedLesson = threadLesson;
+        cachedStage = threadStage;
+    }
+
+    Counters &counters = countersFor(cachedTag);
+    const size_t live = counters.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t total = totalLive.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    const size_t limit = budgetBytes.load(std::memory_order_relaxed);
+    if (limit > 0 && total > limit && !exceededFired.exchange(true))
+    {
+        std::function<void()> callback;
+        {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            callback = reg.onExceeded;
+        }
+        if (callback)
+        {
+            callback();
+        }
+    }
+    return cachedTag;
+}
+
+void recordRelease(int tag, size_t bytes)
+{
+    if (tag < 0)
+    {
+        return;
+    }
+    countersFor(tag).liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    totalLive.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+std::vector<Usage> usage()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    const size_t count = reg.count.load(std::memory_order_acquire);
+    std::vector<Usage> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Counters &counters = reg.tags[i];
+        Usage entry;
+        entry.lesson = counters.lesson;
+        entry.stage = counters.stage;
+        entry.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+        entry.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+        entry.allocations = counters.allocations.load(std::memory_order_relaxed);
+        result.push_back(entry);
+    }
+    return result;
+}
+
+size_t liveBytes()
+{
+    return totalLive.load(std::memory_order_relaxed);
+}
+
+size_t lessonBytes(int lesson)
+{
+    size_t bytes = 0;
+    for (const Usage &entry : usage())
+    {
+        if (entry.lesson == lesson)
+        {
+            bytes += entry.liveBytes;
+        }
+    }
+    return bytes;
+}
+
+void setBudget(size_t bytes, std::function<void()> onExceeded)
+{
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.onExceeded = std::move(onExceeded);
+    }
+    budgetBytes.store(bytes, std::memory_order_relaxed);
+    rearm();
+}
+
+size_t budget()
+{
+    return budgetBytes.load(std::memory_order_relaxed);
+}
+
+void rearm()
+{
+    exceededFired.store(false);
+}
+} // namespace memory_accounting
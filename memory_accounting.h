@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Mat 像素内存记账：MatPool 每次分配时按当前线程的（课程，阶段）标签计数，释放时扣回。
+// 课程号与 lessonRegistry() 下标一致；kSharedLesson 表示多个课程共用（如 ImageCache）。
+// GUI 线程的课程由 MainWindow 在切换页面时设置，后台任务用 Scope 带上提交时的课程。
+namespace memory_accounting
+{
+constexpr int kSharedLesson = -1;
+
+int currentLesson();
+void setCurrentLesson(int lesson);
+
+// 在作用域内把本线程的分配记到 (lesson, stage)；stage 必须是静态字符串
+class Scope
+{
+public:
+    Scope(int lesson, const char *stage);
+    explicit Scope(const char *stage);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    int previousLesson;
+    const char *previousStage;
+};
+
+struct Usage
+{
+    int lesson = kSharedLesson;
+    const char *stage = nullptr;
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+    std::uint64_t allocations = 0;
+};
+
+// 由 MatPool 调用：返回标签号，释放时原样传回
+int recordAllocation(size_t bytes);
+void recordRelease(int tag, size_t bytes);
+
+std::vector<Usage> usage();
+size_t liveBytes();
+// 某课程（所有阶段）当前占用
+size_t lessonBytes(int lesson);
+
+// 超出预算时调用一次 onExceeded（可能在任意线程，须自行转到 GUI 线程），
+// 处理完后调用 rearm() 才会再次触发。bytes 为 0 表示不限
+void setBudget(size_t bytes, std::function<void()> onExceeded);
+size_t budget();
+void rearm();
+} // namespace memory_accounting
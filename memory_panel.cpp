@@ -0,0 +1,162 @@
+#include "memory_panel.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+#include "image_cache.h"
+#include "lesson_registry.h"
+#include "mat_pool.h"
+#include "memory_accounting.h"
+
+namespace
+{
+QString mib(size_t bytes)
+{
+    return QString::number(bytes / 1048576.0, 'f', 1);
+}
+
+QString lessonName(int lesson)
+{
+    const std::vector<LessonDescriptor> &lessons = lessonRegistry();
+    if (lesson >= 0 && lesson < static_cast<int>(lessons.size()))
+    {
+        return lessons[static_cast<size_t>(lesson)].title;
+    }
+    return QStringLiteral("共享");
+}
+} // namespace
+
+MemoryPanel::MemoryPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    auto *layout = new QVBoxLayout(this);
+
+    summaryLabel = new QLabel(this);
+    reportLabel = new QLabel(this);
+    reportLabel->setWordWrap(true);
+    reportLabel->setStyleSheet(QStringLiteral("color: #555;"));
+
+    auto *budgetLayout = new QHBoxLayout();
+    budgetSpin = new QSpinBox(this);
+    budgetSpin->setRange(0, 65536);
+    budgetSpin->setSingleStep(256);
+    budgetSpin->setSuffix(QStringLiteral(" MiB"));
+    budgetSpin->setSpecialValueText(QStringLiteral("不限"));
+    auto *reclaimButton = new QPushButton(QStringLiteral("立即回收"), this);
+    budgetLayout->addWidget(new QLabel(QStringLiteral("预算"), this));
+    budgetLayout->addWidget(budgetSpin, 1);
+    budgetLayout->addWidget(reclaimButton);
+
+    table = new QTableWidget(0, 5, this);
+    table->setHorizontalHeaderLabels({QStringLiteral("课程"),
+                                      QStringLiteral("阶段"),
+                                      QStringLiteral("占用 MiB"),
+                                      QStringLiteral("峰值 MiB"),
+                                      QStringLiteral("分配次数")});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    layout->addWidget(summaryLabel);
+    layout->addLayout(budgetLayout);
+    layout->addWidget(table, 1);
+    layout->addWidget(reportLabel);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(500);
+    connect(refreshTimer, &QTimer::timeout, this, [this]() {
+        refresh();
+    });
+    connect(budgetSpin, &QSpinBox::editingFinished, this, [this]() {
+        if (budgetHandler)
+        {
+            budgetHandler(budgetSpin->value());
+        }
+    });
+    connect(reclaimButton, &QPushButton::clicked, this, [this]() {
+        if (reclaimHandler)
+        {
+            reclaimHandler();
+        }
+        refresh();
+    });
+}
+
+void MemoryPanel::setBudgetHandler(std::function<void(int budgetMiB)> handler)
+{
+    budgetHandler = std::move(handler);
+}
+
+void MemoryPanel::setReclaimHandler(std::function<void()> handler)
+{
+    reclaimHandler = std::move(handler);
+}
+
+void MemoryPanel::setBudgetMiB(int budgetMiB)
+{
+    budgetSpin->setValue(budgetMiB);
+}
+
+void MemoryPanel::setReport(const QString &text)
+{
+    reportLabel->setText(text);
+}
+
+void MemoryPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer->start();
+}
+
+void MemoryPanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    refreshTimer->stop();
+}
+
+void MemoryPanel::refresh()
+{
+    const MatPool::Stats pool = MatPool::instance().stats();
+    const ImageCache::Stats cache = ImageCache::instance().stats();
+    const size_t budget = memory_accounting::budget();
+    summaryLabel->setText(QStringLiteral("Mat 占用 %1 MiB / 预算 %2；池中空闲 %3 MiB；ImageCache %4 MiB（%5 项）")
+                              .arg(mib(memory_accounting::liveBytes()))
+                              .arg(budget ? mib(budget) + QStringLiteral(" MiB") : QStringLiteral("不限"))
+                              .arg(mib(pool.pooledBytes))
+                              .arg(mib(cache.usedBytes))
+                              .arg(cache.entries));
+
+    std::vector<memory_accounting::Usage> usage = memory_accounting::usage();
+    std::sort(usage.begin(), usage.end(), [](const memory_accounting::Usage &a, const memory_accounting::Usage &b) {
+        return a.liveBytes > b.liveBytes;
+    });
+    table->setRowCount(static_cast<int>(usage.size()));
+    for (int row = 0; row < static_cast<int>(usage.size()); ++row)
+    {
+        const memory_accounting::Usage &entry = usage[static_cast<size_t>(row)];
+        const QStringList cells = {lessonName(entry.lesson),
+                                   QString::fromLatin1(entry.stage),
+                                   mib(entry.liveBytes),
+                                   mib(entry.peakBytes),
+                                   QString::number(entry.allocations)};
+        for (int column = 0; column < cells.size(); ++column)
+        {
+            QTableWidgetItem *item = table->item(row, column);
+            if (!item)
+            {
+                item = new QTableWidgetItem();
+                table->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+}
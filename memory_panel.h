@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QWidget>
+
+#include <functional>
+
+class QLabel;
+class QSpinBox;
+class QTableWidget;
+class QTimer;
+
+// 内存面板：按（课程，阶段）列出 Mat 像素内存的当前占用与峰值，
+// 并显示 Mat 池空闲量、ImageCache 占用和预算。只在可见时定时刷新。
+class MemoryPanel : public QWidget
+{
+public:
+    explicit MemoryPanel(QWidget *parent = nullptr);
+
+    // 预算（MiB）被修改、点击“立即回收”时调用
+    void setBudgetHandler(std::function<void(int budgetMiB)> handler);
+    void setReclaimHandler(std::function<void()> handler);
+    void setBudgetMiB(int budgetMiB);
+    void setReport(const QString &text);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    QLabel *summaryLabel = nullptr;
+    QLabel *reportLabel = nullptr;
+    QSpinBox *budgetSpin = nullptr;
+    QTableWidget *table = nullptr;
+    QTimer *refreshTimer = nullptr;
+    std::function<void(int)> budgetHandler;
+    std::function<void()> reclaimHandler;
+
+    void refresh();
+};
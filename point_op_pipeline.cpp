@@ -0,0 +1,146 @@
+#include "point_op_pipeline.h"
+
+#include <cmath>
+
+#include <opencv2/core/utility.hpp>
+
+#include "trace.h"
+
+namespace
+{
+// cv::COLOR_BGR2GRAY 对 8 位图像使用的定点系数（0.299/0.587/0.114 × 2^14）
+constexpr int kGrayShift = 14;
+constexpr int kR2Gray = 4899;
+constexpr int kG2Gray = 9617;
+constexpr int kB2Gray = 1868;
+} // namespace
+
+PointOpPipeline::PointOpPipeline()
+{
+    reset();
+}
+
+template <typename Fn>
+PointOpPipeline &PointOpPipeline::compose(Fn &&fn)
+{
+    for (uchar &value : lut)
+    {
+        value = fn(value);
+    }
+    return *this;
+}
+
+PointOpPipeline &PointOpPipeline::gamma(double g)
+{
+    std::array<uchar, 256> curve;
+    for (int i = 0; i < 256; ++i)
+    {
+        curve[static_cast<size_t>(i)] = cv::saturate_cast<uchar>(std::pow(i / 255.0, g) * 255.0);
+    }
+    return compose([&curve](uchar v) { return curve[v]; });
+}
+
+PointOpPipeline &PointOpPipeline::truncate(double thresh)
+{
+    // 8 位输入时 cv::threshold 先把阈值向下取整
+    const int t = cvFloor(thresh);
+    return compose([t](uchar v) { return v > t ? cv::saturate_cast<uchar>(t) : v; });
+}
+
+PointOpPipeline &PointOpPipeline::threshold(double thresh, double maxValue)
+{
+    const int t = cvFloor(thresh);
+    const uchar high = cv::saturate_cast<uchar>(maxValue);
+    return compose([t, high](uchar v) { return v > t ? high : uchar(0); });
+}
+
+PointOpPipeline &PointOpPipeline::invert()
+{
+    return compose([](uchar v) { return static_cast<uchar>(255 - v); });
+}
+
+PointOpPipeline &PointOpPipeline::linear(double alpha, double beta)
+{
+    return compose([alpha, beta](uchar v) { return cv::saturate_cast<uchar>(v * alpha + beta); });
+}
+
+PointOpPipeline &PointOpPipeline::stretch(double minValue, double maxValue)
+{
+    if (maxValue <= minValue)
+    {
+        return *this;
+    }
+    const double alpha = 255.0 / (maxValue - minValue);
+    return linear(alpha, -minValue * alpha);
+}
+
+void PointOpPipeline::reset()
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        lut[static_cast<size_t>(i)] = static_cast<uchar>(i);
+    }
+}
+
+bool PointOpPipeline::isIdentity() const
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        if (lut[static_cast<size_t>(i)] != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::array<uchar, 256> &PointOpPipeline::table() const
+{
+    return lut;
+}
+
+void PointOpPipeline::apply(const cv::Mat &src, cv::Mat &dst) const
+{
+    TRACE_SCOPE("LUT");
+    CV_Assert(src.depth() == CV_8U);
+    if (isIdentity())
+    {
+        src.copyTo(dst);
+        return;
+    }
+    // cv::LUT 本身已是并行 + SIMD 的单遍查表
+    const cv::Mat table(1, 256, CV_8U, const_cast<uchar *>(lut.data()));
+    cv::LUT(src, table, dst);
+}
+
+void PointOpPipeline::applyToGray(const cv::Mat &src, cv::Mat &dst) const
+{
+    TRACE_SCOPE("gray + LUT");
+    CV_Assert(src.depth() == CV_8U);
+    const int channels = src.channels();
+    if (channels == 1)
+    {
+        apply(src, dst);
+        return;
+    }
+    CV_Assert(channels == 3 || channels == 4);
+
+    // dst 可能与 src 共享缓冲区，先持有 src 的引用再分配输出
+    const cv::Mat input = src;
+    dst.create(input.size(), CV_8UC1);
+    const uchar *table = lut.data();
+
+    cv::parallel_for_(cv::Range(0, input.rows), [&](const cv::Range &range) {
+        for (int y = range.start; y < range.end; ++y)
+        {
+            const uchar *in = input.ptr<uchar>(y);
+            uchar *out = dst.ptr<uchar>(y);
+            for (int x = 0; x < input.cols; ++x, in += channels)
+            {
+                const int gray = (in[0] * kB2Gray + in[1] * kG2Gray + in[2] * kR2Gray + (1 << (kGrayShift - 1)))
+                                 >> kGrayShift;
+                out[x] = table[gray];
+            }
+        }
+    });
+}
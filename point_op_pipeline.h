@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <opencv2/core.hpp>
+
+// 可组合的 8 位点运算流水线：
+// 每个操作都只依赖单个像素的值，所以任意一串操作都能预先合成为一张 256 项查找表，
+// 整条链只需对图像做一遍查表，而不是每个操作各跑一遍、各分配一个输出 Mat。
+// 每一步的结果与对应的 OpenCV 调用（LUT/threshold/bitwise_not/convertTo）逐像素一致。
+//
+//     PointOpPipeline ops;
+//     ops.gamma(0.6).truncate(200).invert();
+//     ops.applyToGray(bgr, output); // 灰度化 + 三个点运算，单遍完成
+class PointOpPipeline
+{
+public:
+    PointOpPipeline();
+
+    // out = (in / 255)^g * 255
+    PointOpPipeline &gamma(double g);
+    // 等价于 cv::threshold(..., thresh, 255, THRESH_TRUNC)
+    PointOpPipeline &truncate(double thresh);
+    // 等价于 cv::threshold(..., thresh, maxValue, THRESH_BINARY)
+    PointOpPipeline &threshold(double thresh, double maxValue = 255.0);
+    // 等价于 cv::bitwise_not
+    PointOpPipeline &invert();
+    // 等价于 convertTo(..., CV_8U, alpha, beta)
+    PointOpPipeline &linear(double alpha, double beta);
+    // 把 [minValue, maxValue] 线性拉伸到 [0, 255]；maxValue <= minValue 时不做变换
+    PointOpPipeline &stretch(double minValue, double maxValue);
+
+    void reset();
+    bool isIdentity() const;
+    const std::array<uchar, 256> &table() const;
+
+    // CV_8U 任意通道数，每个通道使用同一张表
+    void apply(const cv::Mat &src, cv::Mat &dst) const;
+    // 输入为 BGR/BGRA 时把灰度化合并进同一遍（系数与 cv::COLOR_BGR2GRAY 的定点实现相同），
+    // 输入为单通道时等同于 apply；dst 为 CV_8UC1
+    void applyToGray(const cv::Mat &src, cv::Mat &dst) const;
+
+private:
+    template <typename Fn>
+    PointOpPipeline &compose(Fn &&fn);
+
+    std::array<uchar, 256> lut;
+};
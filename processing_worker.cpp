@@ -0,0 +1,128 @@
+#include "processing_worker.h"
+
+#include "memory_accounting.h"
+
+ProcessingWorker::ProcessingWorker(QObject *parent, CancelPolicy cancelPolicy)
+    : QObject(parent)
+    , policy(cancelPolicy)
+{
+    thread = std::thread([this]() { run(); });
+}
+
+ProcessingWorker::~ProcessingWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        pendingJob = nullptr;
+        if (runningToken.flag)
+        {
+            runningToken.flag->store(true);
+        }
+    }
+    wakeup.notify_one();
+    // 在 QObject 析构之前等线程退出：之后不会再有投递给 this 的事件
+    thread.join();
+}
+
+void ProcessingWorker::submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counters.submitted;
+        if (pendingJob)
+        {
+            ++counters.dropped;
+        }
+        pendingJob = std::move(job);
+        pendingGeneration = ++submittedGeneration;
+        pendingLesson = memory_accounting::currentLesson();
+        if (policy == CancelPolicy::CancelInFlight && runningToken.flag)
+        {
+            runningToken.flag->store(true);
+        }
+    }
+    wakeup.notify_one();
+}
+
+void ProcessingWorker::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pendingJob)
+    {
+        ++counters.dropped;
+        pendingJob = nullptr;
+    }
+    if (runningToken.flag)
+    {
+        runningToken.flag->store(true);
+    }
+    // 已经在 GUI 线程排队的旧结果也不再显示
+    cancelledGeneration = submittedGeneration;
+}
+
+ProcessingWorker::Stats ProcessingWorker::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void ProcessingWorker::run()
+{
+    for (;;)
+    {
+        Job job;
+        quint64 generation = 0;
+        int lesson = memory_accounting::kSharedLesson;
+        CancelToken token;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [this]() { return stopping || pendingJob; });
+            if (stopping)
+            {
+                return;
+            }
+            job = std::move(pendingJob);
+            pendingJob = nullptr;
+            generation = pendingGeneration;
+            lesson = pendingLesson;
+            token.flag = std::make_shared<std::atomic<bool>>(false);
+            runningToken = token;
+        }
+
+        Present presentFn;
+        {
+            memory_accounting::Scope tag(lesson, "processing");
+            presentFn = job(token);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        runningToken = CancelToken();
+        if (!presentFn || token.isCancelled())
+        {
+            ++counters.cancelled;
+            continue;
+        }
+        // 持锁投递：析构函数需要同一把锁才能置 stopping，所以此时 this 一定有效
+        QMetaObject::invokeMethod(this, [this, generation, token, presentFn]() {
+            present(generation, token, presentFn);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ProcessingWorker::present(quint64 generation, const CancelToken &token, const Present &presentFn)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 单线程执行保证结果按提交顺序到达；cancel() 之前提交的结果一律作废
+        const bool stale = token.isCancelled() || generation <= cancelledGeneration || generation <= presentedGeneration;
+        if (stale)
+        {
+            ++counters.cancelled;
+            return;
+        }
+        ++counters.completed;
+    }
+    presentedGeneration = generation;
+    presentFn();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QObject>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 后台任务的取消标记。任务应在分块/阶段边界调用 isCancelled()，被取消时尽快返回
+class CancelToken
+{
+public:
+    bool isCancelled() const
+    {
+        return flag && flag->load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class ProcessingWorker;
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+// 每个课程一个的参数处理线程，“最新值优先”：
+// - 邮箱只有一个槽位，新提交直接替换尚未开始的旧任务（计为 dropped）；
+// - CancelInFlight 策略下，新提交还会取消正在执行的任务（在其下一次检查点生效，计为 cancelled）；
+//   KeepInFlight 策略下正在执行的任务会做完并显示，拖动过程中画面持续刷新；
+// - 任务在工作线程里运行，返回一个在 GUI 线程执行的“呈现”函数；
+//   呈现前会再次确认没有被取消、也没有更新的结果已经显示，所以界面上只会出现更新的结果。
+class ProcessingWorker : public QObject
+{
+public:
+    using Present = std::function<void()>;
+    using Job = std::function<Present(const CancelToken &token)>;
+
+    enum class CancelPolicy
+    {
+        KeepInFlight,
+        CancelInFlight
+    };
+
+    struct Stats
+    {
+        quint64 submitted = 0;
+        quint64 dropped = 0;   // 还没开始就被更新的提交替换
+        quint64 cancelled = 0; // 执行中被取消，或结果已过时未显示
+        quint64 completed = 0; // 结果已显示
+    };
+
+    explicit ProcessingWorker(QObject *parent, CancelPolicy policy = CancelPolicy::KeepInFlight);
+    ~ProcessingWorker() override;
+
+    void submit(Job job);
+    // 丢弃待处理任务并取消正在执行的任务，例如换图或离开页面时
+    void cancel();
+    Stats stats() const;
+
+private:
+    void run();
+    void present(quint64 generation, const CancelToken &token, const Present &presentFn);
+
+    const CancelPolicy policy;
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    Job pendingJob;
+    quint64 pendingGeneration = 0;
+    int pendingLesson = 0; // 提交线程所属课程，任务里的 Mat 分配记到该课程
+    quint64 submittedGeneration = 0;
+    quint64 cancelledGeneration = 0;
+    quint64 presentedGeneration = 0; // 只在 GUI 线程访问
+    CancelToken runningToken;
+    bool stopping = false;
+    Stats counters;
+    std::thread thread;
+};
@@ -0,0 +1,253 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace trace
+{
+namespace
+{
+// 每线程保留最近 8192 个事件，约 256 KiB
+constexpr std::uint64_t kRingSize = 8192;
+
+// 一个槽位带序号（seqlock）：写者先把 seq 置为奇数，写完字段后置为 2 * (index + 1)。
+// 读者在拷贝前后各读一次 seq，两次相同且等于该下标期望的值才算完整，
+// 正在写或已被下一圈覆盖的槽位都会被丢弃。字段本身是 relaxed 原子量，读写并发不构成数据竞争。
+struct Slot
+{
+    std::atomic<std::uint64_t> seq{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<std::int64_t> startNs{0};
+    std::atomic<std::int64_t> durationNs{0};
+};
+
+// 环形缓冲区同一时间只由一个线程写入，读写双方都不需要加锁
+struct ThreadRing
+{
+    explicit ThreadRing(std::uint32_t threadId) : threadId(threadId) {}
+
+    std::array<Slot, kRingSize> slots;
+    std::atomic<std::uint64_t> head{0};
+    const std::uint32_t threadId;
+};
+
+// 线程第一次记录时加锁领取缓冲区，退出时归还到空闲列表，供之后新建的线程复用：
+// 线程池会回收空闲线程再新建，批处理每次都起新线程，不复用的话缓冲区会无限增长。
+// 缓冲区本身随进程存活，归还后其中的事件仍可导出，直到被新线程覆盖
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    std::vector<ThreadRing *> freeRings;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+bool initialEnabled()
+{
+    const char *value = std::getenv("OPENCV_LESSONS_TRACE");
+    return value && *value && *value != '0';
+}
+
+std::atomic<bool> enabledFlag{initialEnabled()};
+std::atomic<std::int64_t> interactionStartNs{0};
+std::atomic<std::int64_t> clearedBeforeNs{0};
+
+class RingLease
+{
+public:
+    RingLease()
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (!reg.freeRings.empty())
+        {
+            ring = reg.freeRings.back();
+            reg.freeRings.pop_back();
+            return;
+        }
+        auto created = std::make_shared<ThreadRing>(static_cast<std::uint32_t>(reg.rings.size() + 1));
+        reg.rings.push_back(created);
+        ring = created.get();
+    }
+
+    ~RingLease()
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.freeRings.push_back(ring);
+    }
+
+    RingLease(const RingLease &) = delete;
+    RingLease &operator=(const RingLease &) = delete;
+
+    ThreadRing *ring = nullptr;
+};
+
+ThreadRing &threadRing()
+{
+    thread_local RingLease lease;
+    return *lease.ring;
+}
+
+void collect(const ThreadRing &ring, std::vector<Event> &out)
+{
+    const std::uint64_t head = ring.head.load(std::memory_order_acquire);
+    const std::uint64_t first = head > kRingSize ? head - kRingSize : 0;
+    for (std::uint64_t i = first; i < head; ++i)
+    {
+        const Slot &slot = ring.slots[i % kRingSize];
+        const std::uint64_t expected = 2 * (i + 1);
+        if (slot.seq.load(std::memory_order_acquire) != expected)
+        {
+            continue;
+        }
+        const Event event{slot.name.load(std::memory_order_relaxed),
+                          slot.startNs.load(std::memory_order_relaxed),
+                          slot.durationNs.load(std::memory_order_relaxed),
+                          ring.threadId};
+        // 拷贝期间写者开始覆盖该槽位时 seq 已变，丢弃这份可能拼接了两个事件的拷贝
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == expected)
+        {
+            out.push_back(event);
+        }
+    }
+}
+} // namespace
+
+bool isEnabled()
+{
+    return enabledFlag.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool enabled)
+{
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+std::int64_t nowNs()
+{
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void record(const char *name, std::int64_t startNs, std::int64_t durationNs)
+{
+    ThreadRing &ring = threadRing();
+    const std::uint64_t index = ring.head.load(std::memory_order_relaxed);
+    Slot &slot = ring.slots[index % kRingSize];
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(durationNs, std::memory_order_relaxed);
+    slot.seq.store(2 * (index + 1), std::memory_order_release);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void markInteraction()
+{
+    interactionStartNs.store(nowNs(), std::memory_order_relaxed);
+}
+
+std::vector<StageSummary> summarizeLastInteraction()
+{
+    const std::int64_t since = interactionStartNs.load(std::memory_order_relaxed);
+    std::vector<StageSummary> stages;
+    for (const Event &event : snapshot())
+    {
+        if (event.startNs < since)
+        {
+            continue;
+        }
+        // 阶段名都是字面量，同名通常同址；仍按内容比较以免跨编译单元不合并
+        auto it = std::find_if(stages.begin(), stages.end(), [&](const StageSummary &stage) {
+            return stage.name == event.name || std::strcmp(stage.name, event.name) == 0;
+        });
+        if (it == stages.end())
+        {
+            stages.push_back(StageSummary{event.name});
+            it = stages.end() - 1;
+        }
+        const double ms = event.durationNs / 1e6;
+        ++it->count;
+        it->totalMs += ms;
+        it->maxMs = std::max(it->maxMs, ms);
+    }
+    std::sort(stages.begin(), stages.end(), [](const StageSummary &a, const StageSummary &b) {
+        return a.totalMs > b.totalMs;
+    });
+    return stages;
+}
+
+std::vector<Event> snapshot()
+{
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        rings = reg.rings;
+    }
+
+    std::vector<Event> events;
+    for (const auto &ring : rings)
+    {
+        collect(*ring, events);
+    }
+    const std::int64_t since = clearedBeforeNs.load(std::memory_order_relaxed);
+    events.erase(std::remove_if(events.begin(), events.end(), [since](const Event &event) {
+                     return event.startNs < since;
+                 }),
+                 events.end());
+    std::sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+        return a.startNs < b.startNs;
+    });
+    return events;
+}
+
+bool writeChromeTrace(const std::string &path)
+{
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    // 完整事件（ph = "X"），时间单位为微秒
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    bool first = true;
+    for (const Event &event : snapshot())
+    {
+        std::fprintf(file,
+                     "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                     first ? "" : ",",
+                     event.name,
+                     event.threadId,
+                     event.startNs / 1e3,
+                     event.durationNs / 1e3);
+        first = false;
+    }
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+void clear()
+{
+    // 环形缓冲区的 head 只能由写者推进，这里只移动可见起点
+    const std::int64_t now = nowNs();
+    clearedBeforeNs.store(now, std::memory_order_relaxed);
+    interactionStartNs.store(now, std::memory_order_relaxed);
+}
+} // namespace trace
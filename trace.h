@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 轻量级热路径计时：在关键调用外包一层 TRACE_SCOPE("stage")。
+// 每个线程写自己的环形缓冲区（单生产者，无锁）；关闭时一个 Scope 只多一次 relaxed 原子读。
+// 可在运行时开关，记录可导出为 Chrome trace JSON（chrome://tracing 或 Perfetto 打开）。
+namespace trace
+{
+struct Event
+{
+    const char *name = nullptr; // 必须是静态字符串
+    std::int64_t startNs = 0;   // 相对进程内固定起点
+    std::int64_t durationNs = 0;
+    std::uint32_t threadId = 0;
+};
+
+struct StageSummary
+{
+    const char *name = nullptr;
+    int count = 0;
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+};
+
+bool isEnabled();
+void setEnabled(bool enabled);
+
+std::int64_t nowNs();
+void record(const char *name, std::int64_t startNs, std::int64_t durationNs);
+
+// 标记一次交互的开始（鼠标/键盘输入），summarizeLastInteraction 只统计此后开始的事件
+void markInteraction();
+// 按阶段名汇总上次交互以来的事件，按总耗时降序
+std::vector<StageSummary> summarizeLastInteraction();
+
+// 所有线程缓冲区中仍保留的事件，按开始时间排序
+std::vector<Event> snapshot();
+bool writeChromeTrace(const std::string &path);
+void clear();
+
+class Scope
+{
+public:
+    explicit Scope(const char *name) : name(isEnabled() ? name : nullptr), startNs(this->name ? nowNs() : 0) {}
+    ~Scope()
+    {
+        if (name)
+        {
+            record(name, startNs, nowNs() - startNs);
+        }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *name;
+    std::int64_t startNs;
+};
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
@@ -0,0 +1,104 @@
+#include "trace_overlay.h"
+
+#include <QTimer>
+
+#include "highgui_pump.h"
+#include "large_pages.h"
+#include "mat_pool.h"
+#include "trace.h"
+
+TraceOverlay::TraceOverlay(QWidget *parent)
+    : QLabel(parent)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setTextFormat(Qt::PlainText);
+    setStyleSheet(QStringLiteral("background: rgba(0, 0, 0, 170); color: #e8e8e8; "
+                                 "font-family: monospace; font-size: 11px; padding: 6px;"));
+    hide();
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(250);
+    connect(refreshTimer, &QTimer::timeout, this, [this]() {
+        refresh();
+    });
+}
+
+void TraceOverlay::setActive(bool active)
+{
+    if (active)
+    {
+        refresh();
+        show();
+        raise();
+        refreshTimer->start();
+    }
+    else
+    {
+        refreshTimer->stop();
+        hide();
+    }
+}
+
+void TraceOverlay::setFooter(const QString &text)
+{
+    footer = text;
+    if (isVisible())
+    {
+        refresh();
+    }
+}
+
+void TraceOverlay::refresh()
+{
+    QStringList lines;
+    lines.append(QStringLiteral("上次交互各阶段耗时      次数    总计ms    最大ms"));
+    for (const trace::StageSummary &stage : trace::summarizeLastInteraction())
+    {
+        lines.append(QStringLiteral("%1 %2 %3 %4")
+                         .arg(QString::fromLatin1(stage.name), -22)
+                         .arg(stage.count, 6)
+                         .arg(stage.totalMs, 9, 'f', 2)
+                         .arg(stage.maxMs, 9, 'f', 2));
+    }
+    if (lines.size() == 1)
+    {
+        lines.append(QStringLiteral("（暂无记录）"));
+    }
+    const MatPool::Stats pool = MatPool::instance().stats();
+    lines.append(QStringLiteral("Mat 池：命中率 %1%（%2/%3），使用 %4 MiB，空闲 %5 / %6 MiB，峰值 %7 MiB%8")
+                     .arg(pool.hitRate() * 100.0, 0, 'f', 1)
+                     .arg(pool.hits)
+                     .arg(pool.hits + pool.misses)
+                     .arg(pool.inUseBytes / 1048576.0, 0, 'f', 1)
+                     .arg(pool.pooledBytes / 1048576.0, 0, 'f', 1)
+                     .arg(pool.limitBytes / 1048576.0, 0, 'f', 0)
+                     .arg(pool.peakBytes / 1048576.0, 0, 'f', 1)
+                     .arg(pool.releaseFailures ? QStringLiteral("，归还失败 %1 块").arg(pool.releaseFailures)
+                                               : QString()));
+    lines.append(QStringLiteral("缺页：minor %1，major %2；大页：%3")
+                     .arg(large_pages::minorFaults())
+                     .arg(large_pages::majorFaults())
+                     .arg(pool.largeThresholdBytes ? QStringLiteral("开启（%1 次映射，其中 hugetlb %2）")
+                                                         .arg(pool.largeAllocations)
+                                                         .arg(pool.hugeTlbAllocations)
+                                                   : QStringLiteral("关闭")));
+    // 空闲时这里应为 0 次/秒：没有 OpenCV 窗口，或由 Qt 事件循环直接处理
+    HighGuiPump &pump = HighGuiPump::instance();
+    lines.append(QStringLiteral("HighGUI 事件泵：%1，唤醒 %2 次/秒（累计 %3）")
+                     .arg(pump.usesQtEventLoop() ? QStringLiteral("Qt 事件循环")
+                                                 : (pump.isRunning() ? QStringLiteral("运行中") : QStringLiteral("已停止")))
+                     .arg(pump.wakeupsPerSecond())
+                     .arg(pump.totalWakeups()));
+    lines.append(QStringLiteral("Ctrl+Shift+T 关闭跟踪，Ctrl+Shift+S 导出 Chrome trace"));
+    if (!footer.isEmpty())
+    {
+        lines.append(footer);
+    }
+    setText(lines.join(QLatin1Char('\n')));
+
+    adjustSize();
+    if (QWidget *owner = parentWidget())
+    {
+        move(owner->width() - width() - 8, 8);
+    }
+}
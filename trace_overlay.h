@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QLabel>
+
+class QTimer;
+
+// 主窗口右上角的半透明面板：显示上一次交互（鼠标/键盘输入）以来各阶段的次数与耗时。
+// 只在跟踪开启时显示并定时刷新，不拦截鼠标事件。
+class TraceOverlay : public QLabel
+{
+public:
+    explicit TraceOverlay(QWidget *parent);
+
+    void setActive(bool active);
+    // 在面板底部附加一行提示（如导出结果）
+    void setFooter(const QString &text);
+
+private:
+    QTimer *refreshTimer = nullptr;
+    QString footer;
+
+    void refresh();
+};